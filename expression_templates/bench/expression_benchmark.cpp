@@ -0,0 +1,464 @@
+// expression_benchmark.cpp
+// 表达式模板基准测试
+//
+// 用法: expression_benchmark [--quick] [--max-elements N] [--json 文件名]
+//   --quick           只测到约L3大小，重复次数减少，用于快速回归
+//   --max-elements N  最大向量长度（默认 4M 个double，工作集128MB）
+//   --json 文件名     把结果写成JSON（默认 expression_benchmark.json）
+//
+// 对每个长度（工作集从L1一直扩大到内存），对 a + b * s - c 分别测量：
+//   handwritten  - 手写循环，作为参照
+//   traditional  - traditionalComplex，每次分配结果向量
+//   et_scalar    - 表达式模板，强制标量路径
+//   et_simd      - 表达式模板，运行时选择的SIMD路径
+//   et_parallel  - 表达式模板，SIMD + 线程池
+//   et_runtime   - 同一公式在运行时建图、编译为字节码后按块解释执行
+// 每个变体先预热，再重复多次取中位数
+//
+// 第二部分固定向量长度，让求和表达式的叶子数从2增加到24，比较：
+//   flat            - 普通赋值，一个循环同时读取所有叶子
+//   tiled           - result.assign(expr, tiled)，按L1大小分块
+//   tiled_prefetch  - 分块并在每块开始时软件预取后面的数据
+//
+// 第三部分对许多长度为4的小向量计算 r = a * dot(a, b) + b，按每个实体的耗时比较：
+//   vector_loop         - std::vector<Vector<double>>，逐个向量赋值
+//   small_vector_loop   - std::vector<SmallVector<double, 4>>，逐个向量赋值（不分配堆内存）
+//   batch_soa           - Batch<double, 4>，分量分开存储，在实体方向上向量化
+//   batch_soa_parallel  - 同上，实体分块交给线程池
+#include "ExpressionTemplates.hpp"
+#include "RuntimeExpression.hpp"
+#include "SmallVector.hpp"
+#include "Batch.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define ET_HAS_RDTSC 1
+#else
+#define ET_HAS_RDTSC 0
+#endif
+
+using namespace ExpressionTemplates;
+
+namespace {
+
+struct Options {
+    bool quick = false;
+    size_t maxElements = size_t{1} << 22;
+    std::string jsonPath = "expression_benchmark.json";
+};
+
+struct LeafMeasurement {
+    std::string variant;
+    size_t leaves;
+    size_t elements;
+    double medianNs;
+    double gbPerSecond;
+};
+
+struct BatchMeasurement {
+    std::string variant;
+    size_t entities;
+    size_t components;
+    double medianNs;
+    double nsPerEntity;
+};
+
+struct Measurement {
+    std::string variant;
+    size_t elements;
+    size_t workingSetBytes;
+    double medianNs;        // 一次完整求值的时间
+    double gbPerSecond;
+    double elementsPerCycle;  // 以TSC计数为周期，0 表示平台不支持
+    double maxRelativeError;  // 与手写循环的结果相比
+};
+
+uint64_t readCycleCounter() {
+#if ET_HAS_RDTSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// 粗略地按工作集大小标出所在的存储层级
+const char* memoryLevel(size_t bytes) {
+    if (bytes <= (size_t{32} << 10)) return "L1";
+    if (bytes <= (size_t{1} << 20)) return "L2";
+    if (bytes <= (size_t{32} << 20)) return "L3";
+    return "DRAM";
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    size_t mid = values.size() / 2;
+    return values.size() % 2 ? values[mid] : (values[mid - 1] + values[mid]) / 2;
+}
+
+// 先预热并确定每个样本内的迭代次数（使单个样本不短于minSampleNs），
+// 然后采集samples个样本，返回单次迭代的中位耗时与中位TSC周期数
+std::pair<double, double> measure(const std::function<void()>& body, size_t samples,
+                                  double minSampleNs) {
+    using Clock = std::chrono::steady_clock;
+    body();
+    size_t iterations = 1;
+    for (;;) {
+        auto start = Clock::now();
+        for (size_t k = 0; k < iterations; ++k) {
+            body();
+        }
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        if (ns >= minSampleNs || iterations >= (size_t{1} << 24)) {
+            break;
+        }
+        iterations *= 2;
+    }
+
+    std::vector<double> times;
+    std::vector<double> cycles;
+    for (size_t s = 0; s < samples; ++s) {
+        auto start = Clock::now();
+        uint64_t startCycles = readCycleCounter();
+        for (size_t k = 0; k < iterations; ++k) {
+            body();
+        }
+        uint64_t endCycles = readCycleCounter();
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        times.push_back(ns / static_cast<double>(iterations));
+        cycles.push_back(static_cast<double>(endCycles - startCycles) /
+                         static_cast<double>(iterations));
+    }
+    return {median(times), median(cycles)};
+}
+
+double maxRelativeError(const Vector<double>& result, const Vector<double>& reference) {
+    double worst = 0.0;
+    for (size_t i = 0; i < reference.size(); ++i) {
+        double scale = std::max(std::abs(reference[i]), 1.0);
+        worst = std::max(worst, std::abs(result[i] - reference[i]) / scale);
+    }
+    return worst;
+}
+
+Options parseOptions(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--quick") {
+            options.quick = true;
+            options.maxElements = std::min(options.maxElements, size_t{1} << 20);
+        } else if (arg == "--max-elements" && i + 1 < argc) {
+            options.maxElements = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--json" && i + 1 < argc) {
+            options.jsonPath = argv[++i];
+        } else {
+            throw std::invalid_argument("未知参数: " + arg);
+        }
+    }
+    return options;
+}
+
+// 叶子数为 sizeof...(I) 的求和表达式 leaves[0] + leaves[1] + ...
+template<size_t... I>
+auto sumOfLeaves(const std::vector<Vector<double>>& leaves, std::index_sequence<I...>) {
+    return (leaves[I] + ...);
+}
+
+template<size_t Leaves>
+void leafSweep(size_t n, size_t samples, double minSampleNs,
+               std::vector<LeafMeasurement>& results) {
+    std::vector<Vector<double>> leaves;
+    leaves.reserve(Leaves);
+    for (size_t k = 0; k < Leaves; ++k) {
+        leaves.emplace_back(n, static_cast<double>(k + 1));
+    }
+    Vector<double> result(n);
+    const auto indices = std::make_index_sequence<Leaves>{};
+    const double expected = static_cast<double>(Leaves * (Leaves + 1) / 2);
+    // 读 Leaves 个向量、写一个向量
+    const size_t bytes = (Leaves + 1) * n * sizeof(double);
+
+    struct Variant {
+        const char* name;
+        std::function<void()> body;
+    };
+    const Tiling withPrefetch{tiled.footprintBytes, 1024};
+    std::vector<Variant> variants = {
+        {"flat", [&] { result = sumOfLeaves(leaves, indices); }},
+        {"tiled", [&] { result.assign(sumOfLeaves(leaves, indices), tiled); }},
+        {"tiled_prefetch", [&] { result.assign(sumOfLeaves(leaves, indices), withPrefetch); }},
+    };
+    for (const Variant& variant : variants) {
+        result = Vector<double>(n, 0.0);
+        double ns = measure(variant.body, samples, minSampleNs).first;
+        LeafMeasurement m{variant.name, Leaves, n, ns, static_cast<double>(bytes) / ns};
+        results.push_back(m);
+        std::cout << std::left << std::setw(8) << Leaves << std::setw(16) << m.variant
+                  << std::right << std::fixed << std::setprecision(1) << std::setw(14)
+                  << m.medianNs << std::setprecision(2) << std::setw(10) << m.gbPerSecond
+                  << std::defaultfloat << std::setprecision(6);
+        if (result[n / 2] != expected) {
+            std::cout << "  结果不一致!";
+        }
+        std::cout << std::endl;
+    }
+}
+
+// 许多小向量上的同一个表达式：逐个向量求值与按SoA批量求值
+template<size_t K>
+void batchSweep(size_t entities, size_t samples, double minSampleNs,
+                std::vector<BatchMeasurement>& results) {
+    std::vector<Vector<double>> as, bs, rs;
+    std::vector<SmallVector<double, K>> smallAs, smallBs, smallRs;
+    Batch<double, K> a(entities), b(entities), r(entities);
+    for (size_t e = 0; e < entities; ++e) {
+        Vector<double> x(K), y(K);
+        for (size_t k = 0; k < K; ++k) {
+            x[k] = static_cast<double>((e + k) % 97) * 0.01;
+            y[k] = static_cast<double>((e * 3 + k) % 89) * 0.02;
+            a(e, k) = x[k];
+            b(e, k) = y[k];
+        }
+        smallAs.emplace_back(x);
+        smallBs.emplace_back(y);
+        as.push_back(std::move(x));
+        bs.push_back(std::move(y));
+    }
+    rs.assign(entities, Vector<double>(K));
+    smallRs.assign(entities, SmallVector<double, K>(K));
+
+    // 结果按实体、分量展开，与各变体比较
+    std::vector<double> reference(entities * K);
+    for (size_t e = 0; e < entities; ++e) {
+        double d = 0.0;
+        for (size_t k = 0; k < K; ++k) {
+            d += a(e, k) * b(e, k);
+        }
+        for (size_t k = 0; k < K; ++k) {
+            reference[e * K + k] = a(e, k) * d + b(e, k);
+        }
+    }
+
+    struct Variant {
+        const char* name;
+        std::function<void()> body;
+        std::function<double(size_t, size_t)> value;
+    };
+    std::vector<Variant> variants = {
+        {"vector_loop",
+         [&] {
+             for (size_t e = 0; e < entities; ++e) {
+                 rs[e] = as[e] * dot(as[e], bs[e]) + bs[e];
+             }
+         },
+         [&](size_t e, size_t k) { return rs[e][k]; }},
+        {"small_vector_loop",
+         [&] {
+             for (size_t e = 0; e < entities; ++e) {
+                 smallRs[e] = smallAs[e] * dot(smallAs[e], smallBs[e]) + smallBs[e];
+             }
+         },
+         [&](size_t e, size_t k) { return smallRs[e][k]; }},
+        {"batch_soa", [&] { r = a * dot(a, b) + b; }, [&](size_t e, size_t k) { return r(e, k); }},
+        {"batch_soa_parallel", [&] { r.assign(a * dot(a, b) + b, parallel); },
+         [&](size_t e, size_t k) { return r(e, k); }},
+    };
+    for (const Variant& variant : variants) {
+        double ns = measure(variant.body, samples, minSampleNs).first;
+        BatchMeasurement m{variant.name, entities, K, ns, ns / static_cast<double>(entities)};
+        results.push_back(m);
+        std::cout << std::left << std::setw(10) << entities << std::setw(20) << m.variant
+                  << std::right << std::fixed << std::setprecision(1) << std::setw(14)
+                  << m.medianNs << std::setprecision(3) << std::setw(12) << m.nsPerEntity
+                  << std::defaultfloat << std::setprecision(6);
+        double worst = 0.0;
+        for (size_t e = 0; e < entities; ++e) {
+            for (size_t k = 0; k < K; ++k) {
+                const double expected = reference[e * K + k];
+                worst = std::max(worst, std::abs(variant.value(e, k) - expected) /
+                                            std::max(std::abs(expected), 1.0));
+            }
+        }
+        if (worst > 1e-12) {
+            std::cout << "  结果不一致! 最大相对误差 " << worst;
+        }
+        std::cout << std::endl;
+    }
+}
+
+void writeJson(const Options& options, const std::vector<Measurement>& results,
+               const std::vector<LeafMeasurement>& leafResults,
+               const std::vector<BatchMeasurement>& batchResults) {
+    std::ofstream out(options.jsonPath);
+    if (!out) {
+        throw std::runtime_error("无法写入 " + options.jsonPath);
+    }
+    out << "{\n";
+    out << "  \"kernel\": \"a + b * s - c\",\n";
+    out << "  \"value_type\": \"double\",\n";
+    out << "  \"simd_level\": \"" << simdLevelName(simdLevel()) << "\",\n";
+    out << "  \"threads\": " << ThreadPool::instance().workerCount() + 1 << ",\n";
+    out << "  \"cycle_counter\": \"" << (ET_HAS_RDTSC ? "tsc" : "none") << "\",\n";
+    out << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Measurement& m = results[i];
+        out << "    {\"variant\": \"" << m.variant << "\", \"elements\": " << m.elements
+            << ", \"working_set_bytes\": " << m.workingSetBytes
+            << ", \"memory_level\": \"" << memoryLevel(m.workingSetBytes) << "\""
+            << ", \"median_ns\": " << m.medianNs << ", \"gb_per_s\": " << m.gbPerSecond
+            << ", \"elements_per_cycle\": " << m.elementsPerCycle
+            << ", \"max_relative_error\": " << m.maxRelativeError << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ],\n";
+    out << "  \"leaf_sweep\": [\n";
+    for (size_t i = 0; i < leafResults.size(); ++i) {
+        const LeafMeasurement& m = leafResults[i];
+        out << "    {\"variant\": \"" << m.variant << "\", \"leaves\": " << m.leaves
+            << ", \"elements\": " << m.elements << ", \"median_ns\": " << m.medianNs
+            << ", \"gb_per_s\": " << m.gbPerSecond << "}"
+            << (i + 1 < leafResults.size() ? ",\n" : "\n");
+    }
+    out << "  ],\n";
+    out << "  \"batch\": [\n";
+    for (size_t i = 0; i < batchResults.size(); ++i) {
+        const BatchMeasurement& m = batchResults[i];
+        out << "    {\"variant\": \"" << m.variant << "\", \"entities\": " << m.entities
+            << ", \"components\": " << m.components << ", \"median_ns\": " << m.medianNs
+            << ", \"ns_per_entity\": " << m.nsPerEntity << "}"
+            << (i + 1 < batchResults.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        Options options = parseOptions(argc, argv);
+        const size_t samples = options.quick ? 5 : 11;
+        const double minSampleNs = options.quick ? 2e5 : 1e6;
+        const SimdLevel detected = simdLevel();
+
+        std::cout << "===== 表达式模板基准测试: a + b * s - c =====" << std::endl;
+        std::cout << "SIMD指令集: " << simdLevelName(detected)
+                  << ", 线程数: " << ThreadPool::instance().workerCount() + 1
+                  << ", 每项 " << samples << " 个样本取中位数" << std::endl;
+        std::cout << std::left << std::setw(10) << "元素数" << std::setw(8) << "层级"
+                  << std::setw(14) << "变体" << std::right << std::setw(14) << "中位耗时(ns)"
+                  << std::setw(10) << "GB/s" << std::setw(12) << "元素/周期" << std::endl;
+
+        std::vector<Measurement> results;
+        for (size_t n = size_t{1} << 10; n <= options.maxElements; n *= 4) {
+            Vector<double> a(n), b(n), c(n);
+            for (size_t i = 0; i < n; ++i) {
+                a[i] = static_cast<double>(i % 97) * 0.5;
+                b[i] = static_cast<double>(i % 89) * 0.25;
+                c[i] = static_cast<double>(i % 83);
+            }
+            const double s = 2.5;
+            // 读三个向量、写一个向量
+            const size_t bytes = 4 * n * sizeof(double);
+
+            Vector<double> reference(n);
+            Vector<double> result(n);
+            auto handwritten = [&] {
+                const double* pa = a.data();
+                const double* pb = b.data();
+                const double* pc = c.data();
+                double* pr = reference.data();
+                for (size_t i = 0; i < n; ++i) {
+                    pr[i] = pa[i] + pb[i] * s - pc[i];
+                }
+            };
+
+            ExpressionGraph<double> graph;
+            CompiledExpression<double> program =
+                graph.compile(graph.input(a) + graph.input(b) * s - graph.input(c));
+
+            struct Variant {
+                const char* name;
+                std::function<void()> body;
+                SimdLevel level;
+            };
+            std::vector<Variant> variants = {
+                {"handwritten", handwritten, detected},
+                {"traditional", [&] { result = traditionalComplex(a, b, c, s); }, detected},
+                {"et_scalar", [&] { result = a + b * s - c; }, SimdLevel::Scalar},
+                {"et_simd", [&] { result = a + b * s - c; }, detected},
+                {"et_parallel", [&] { result.assign(a + b * s - c, parallel); }, detected},
+                {"et_runtime", [&] { result = program; }, detected},
+            };
+
+            for (const Variant& variant : variants) {
+                setSimdLevel(variant.level);
+                auto [ns, cycles] = measure(variant.body, samples, minSampleNs);
+                setSimdLevel(detected);
+
+                Measurement m;
+                m.variant = variant.name;
+                m.elements = n;
+                m.workingSetBytes = bytes;
+                m.medianNs = ns;
+                m.gbPerSecond = static_cast<double>(bytes) / ns;
+                m.elementsPerCycle = cycles > 0 ? static_cast<double>(n) / cycles : 0.0;
+                m.maxRelativeError = &variant == &variants.front()
+                                         ? 0.0
+                                         : maxRelativeError(result, reference);
+                results.push_back(m);
+
+                std::cout << std::left << std::setw(10) << n << std::setw(8)
+                          << memoryLevel(bytes) << std::setw(14) << m.variant << std::right
+                          << std::fixed << std::setprecision(1) << std::setw(14) << m.medianNs
+                          << std::setprecision(2) << std::setw(10) << m.gbPerSecond
+                          << std::setprecision(3) << std::setw(12) << m.elementsPerCycle
+                          << std::defaultfloat << std::setprecision(6);
+                if (m.maxRelativeError > 1e-12) {
+                    std::cout << "  结果不一致! 最大相对误差 " << m.maxRelativeError;
+                }
+                std::cout << std::endl;
+            }
+        }
+
+        const size_t leafElements = std::min(options.maxElements, size_t{1} << 20);
+        std::cout << "\n===== 叶子数扫描: 每个向量 " << leafElements << " 个元素 =====" << std::endl;
+        std::cout << std::left << std::setw(8) << "叶子数" << std::setw(16) << "变体" << std::right
+                  << std::setw(14) << "中位耗时(ns)" << std::setw(10) << "GB/s" << std::endl;
+        std::vector<LeafMeasurement> leafResults;
+        leafSweep<2>(leafElements, samples, minSampleNs, leafResults);
+        leafSweep<4>(leafElements, samples, minSampleNs, leafResults);
+        leafSweep<8>(leafElements, samples, minSampleNs, leafResults);
+        leafSweep<12>(leafElements, samples, minSampleNs, leafResults);
+        leafSweep<16>(leafElements, samples, minSampleNs, leafResults);
+        leafSweep<24>(leafElements, samples, minSampleNs, leafResults);
+
+        std::cout << "\n===== 批量小向量: r = a * dot(a, b) + b, 每个向量4个元素 ====="
+                  << std::endl;
+        std::cout << std::left << std::setw(10) << "实体数" << std::setw(20) << "变体" << std::right
+                  << std::setw(14) << "中位耗时(ns)" << std::setw(12) << "ns/实体" << std::endl;
+        std::vector<BatchMeasurement> batchResults;
+        const size_t maxEntities = std::min(options.maxElements / 4, size_t{1} << 20);
+        for (size_t entities = size_t{1} << 10; entities <= maxEntities; entities *= 16) {
+            batchSweep<4>(entities, samples, minSampleNs, batchResults);
+        }
+
+        writeJson(options, results, leafResults, batchResults);
+        std::cout << "结果已写入 " << options.jsonPath << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "异常: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
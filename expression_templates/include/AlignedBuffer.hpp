@@ -0,0 +1,195 @@
+// AlignedBuffer.hpp
+#ifndef ALIGNED_BUFFER_HPP
+#define ALIGNED_BUFFER_HPP
+
+#include <cstddef>
+#include <new>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+namespace ExpressionTemplates {
+
+// 用作重载标签：构造时不初始化元素，由随后的表达式求值直接写入
+struct UninitializedTag {};
+inline constexpr UninitializedTag uninitialized{};
+
+// ========================
+// 按缓存行对齐的动态数组
+// ========================
+// 与std::vector相比：
+//   1. 首地址按Alignment（默认64字节，即一个缓存行/一个AVX-512寄存器）对齐；
+//   2. 可以跳过初始化，表达式结果不必先清零再覆盖，省掉一次完整的写遍历
+// 条款13: 以对象管理资源
+template<typename T, size_t Alignment = 64>
+class AlignedBuffer {
+public:
+    static_assert(Alignment >= alignof(T) && (Alignment & (Alignment - 1)) == 0,
+                  "对齐必须是2的幂且不小于元素的对齐要求");
+
+    AlignedBuffer() noexcept = default;
+
+    // 值初始化（算术类型为0），与std::vector(size)一致
+    explicit AlignedBuffer(size_t size) : AlignedBuffer(Capacity{size}) {
+        std::uninitialized_value_construct(data_, data_ + size);
+        size_ = size;
+    }
+
+    AlignedBuffer(size_t size, const T& value) : AlignedBuffer(Capacity{size}) {
+        std::uninitialized_fill(data_, data_ + size, value);
+        size_ = size;
+    }
+
+    // 默认初始化：平凡类型不写任何内存
+    AlignedBuffer(size_t size, UninitializedTag) : AlignedBuffer(Capacity{size}) {
+        if constexpr (!std::is_trivially_default_constructible_v<T>) {
+            std::uninitialized_default_construct(data_, data_ + size);
+        }
+        size_ = size;
+    }
+
+    // 条款12: 复制对象时勿忘其每一个成分
+    AlignedBuffer(const AlignedBuffer& other) : AlignedBuffer(Capacity{other.size_}) {
+        std::uninitialized_copy(other.data_, other.data_ + other.size_, data_);
+        size_ = other.size_;
+    }
+
+    AlignedBuffer(AlignedBuffer&& other) noexcept {
+        swap(other);
+    }
+
+    // 条款11: 在operator=中处理"自我赋值"（copy and swap）
+    AlignedBuffer& operator=(AlignedBuffer other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    ~AlignedBuffer() {
+        release();
+    }
+
+    // 条款25: 考虑写出一个不抛异常的swap函数
+    void swap(AlignedBuffer& other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+    }
+
+    // 改变大小，保留已有元素，新增元素值初始化
+    void resize(size_t size) {
+        if (size > capacity_) {
+            AlignedBuffer grown(Capacity{size});
+            std::uninitialized_move(data_, data_ + size_, grown.data_);
+            grown.size_ = size_;
+            std::uninitialized_value_construct(grown.data_ + size_, grown.data_ + size);
+            grown.size_ = size;
+            swap(grown);
+            return;
+        }
+        if (size > size_) {
+            std::uninitialized_value_construct(data_ + size_, data_ + size);
+        } else if constexpr (!std::is_trivially_destructible_v<T>) {
+            std::destroy(data_ + size, data_ + size_);
+        }
+        size_ = size;
+    }
+
+    // 改变大小，不保证保留任何元素的值：调用者会随即覆盖全部元素
+    void resizeForOverwrite(size_t size) {
+        if (size > capacity_) {
+            AlignedBuffer fresh(size, uninitialized);
+            swap(fresh);
+            return;
+        }
+        if (size > size_) {
+            if constexpr (!std::is_trivially_default_constructible_v<T>) {
+                std::uninitialized_default_construct(data_ + size_, data_ + size);
+            }
+        } else if constexpr (!std::is_trivially_destructible_v<T>) {
+            std::destroy(data_ + size, data_ + size_);
+        }
+        size_ = size;
+    }
+
+    T& operator[](size_t i) {
+        return data_[i];
+    }
+
+    const T& operator[](size_t i) const {
+        return data_[i];
+    }
+
+    T* data() noexcept {
+        return data_;
+    }
+
+    const T* data() const noexcept {
+        return data_;
+    }
+
+    size_t size() const noexcept {
+        return size_;
+    }
+
+    size_t capacity() const noexcept {
+        return capacity_;
+    }
+
+    T* begin() noexcept {
+        return data_;
+    }
+
+    T* end() noexcept {
+        return data_ + size_;
+    }
+
+    const T* begin() const noexcept {
+        return data_;
+    }
+
+    const T* end() const noexcept {
+        return data_ + size_;
+    }
+
+private:
+    // 只分配内存、不构造元素；委托构造完成后即使随后抛出异常，析构函数也会释放内存
+    // 条款29: 为"异常安全"努力是值得的
+    struct Capacity {
+        size_t value;
+    };
+
+    explicit AlignedBuffer(Capacity capacity)
+        : data_(allocate(capacity.value)), capacity_(capacity.value) {}
+
+    static T* allocate(size_t size) {
+        if (size == 0) {
+            return nullptr;
+        }
+        return static_cast<T*>(::operator new(size * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void release() noexcept {
+        if (data_) {
+            if constexpr (!std::is_trivially_destructible_v<T>) {
+                std::destroy(data_, data_ + size_);
+            }
+            ::operator delete(data_, std::align_val_t(Alignment));
+        }
+        data_ = nullptr;
+        size_ = capacity_ = 0;
+    }
+
+    T* data_ = nullptr;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+};
+
+template<typename T, size_t Alignment>
+void swap(AlignedBuffer<T, Alignment>& a, AlignedBuffer<T, Alignment>& b) noexcept {
+    a.swap(b);
+}
+
+} // namespace ExpressionTemplates
+
+#endif // ALIGNED_BUFFER_HPP
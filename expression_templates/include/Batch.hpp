@@ -0,0 +1,633 @@
+// Batch.hpp
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "ExpressionTemplates.hpp"
+#include "ElementwiseOps.hpp"
+#include "Reductions.hpp"
+
+namespace ExpressionTemplates {
+
+// ========================
+// 批量小向量（结构数组布局）
+// ========================
+// 大量互相独立的短向量（每个实体的位置、速度、状态……）逐个用 Vector 计算时，
+// 每个向量只有几个元素，凑不满一个寄存器，循环和调用的开销比运算本身还大。
+// Batch<T, K> 保存 count 个长度为 K 的向量，按分量分开存储（SoA）：
+// 第k个分量的全部 count 个值连续存放，相邻分量相距 stride() 个元素。
+// 表达式在实体方向上向量化，一个寄存器同时计算 N 个实体的同一个分量：
+//   Batch<double, 3> position(count), velocity(count);
+//   Batch<double, 1> mass(count);
+//   position = position + velocity * dt;                 // 标量按实体广播
+//   Batch<double, 3> force = velocity * mass;             // K = 1 的操作数广播到每个分量
+//   Batch<double, 1> speed = norm2(velocity);             // 每个实体的分量之间归约
+// K 是编译期常量：一个实体的全部分量在寄存器中算完后才写回，
+// 因此 dot(x, x) 这样跨分量读取目标的表达式也可以原地赋值
+
+template<typename T, size_t K>
+class Batch;
+
+template<typename LhsExpr, typename RhsExpr, typename Op>
+class BatchBinaryOp;
+
+template<typename Expr, typename Op>
+class BatchUnaryOp;
+
+template<typename Expr>
+class BatchScaled;
+
+template<typename LhsExpr, typename RhsExpr>
+class BatchDot;
+
+namespace detail {
+
+// N 个实体的 K 个分量：每个分量一个packet
+template<typename T, size_t N, size_t K>
+using ComponentPackets = std::array<Packet<T, N>, K>;
+
+// 批量表达式每个实体的分量数
+template<typename Expr>
+inline constexpr size_t batch_components_v = ExpressionTraits<Expr>::components;
+
+// 逐元素运算的两个操作数：分量数相同，或其中一个为1
+template<typename LhsExpr, typename RhsExpr>
+constexpr size_t broadcastComponents() {
+    constexpr size_t lhs = batch_components_v<LhsExpr>;
+    constexpr size_t rhs = batch_components_v<RhsExpr>;
+    static_assert(lhs == rhs || lhs == 1 || rhs == 1, "批量表达式的分量数不能广播");
+    return lhs < rhs ? rhs : lhs;
+}
+
+} // namespace detail
+
+template<typename T, size_t K>
+struct ExpressionTraits<Batch<T, K>> {
+    using value_type = T;
+    static constexpr bool vectorizable = detail::is_packet_type<T>;
+    static constexpr size_t static_size = 0;
+    static constexpr size_t components = K;
+};
+
+template<typename LhsExpr, typename RhsExpr, typename Op>
+struct ExpressionTraits<BatchBinaryOp<LhsExpr, RhsExpr, Op>> {
+    using value_type = expression_value_t<LhsExpr>;
+    static constexpr bool vectorizable = ExpressionTraits<LhsExpr>::vectorizable;
+    static constexpr size_t static_size = 0;
+    static constexpr size_t components = detail::broadcastComponents<LhsExpr, RhsExpr>();
+};
+
+template<typename Expr, typename Op>
+struct ExpressionTraits<BatchUnaryOp<Expr, Op>> {
+    using value_type = expression_value_t<Expr>;
+    static constexpr bool vectorizable = ExpressionTraits<Expr>::vectorizable;
+    static constexpr size_t static_size = 0;
+    static constexpr size_t components = detail::batch_components_v<Expr>;
+};
+
+template<typename Expr>
+struct ExpressionTraits<BatchScaled<Expr>> {
+    using value_type = expression_value_t<Expr>;
+    static constexpr bool vectorizable = ExpressionTraits<Expr>::vectorizable;
+    static constexpr size_t static_size = 0;
+    static constexpr size_t components = detail::batch_components_v<Expr>;
+};
+
+template<typename LhsExpr, typename RhsExpr>
+struct ExpressionTraits<BatchDot<LhsExpr, RhsExpr>> {
+    using value_type = expression_value_t<LhsExpr>;
+    static constexpr bool vectorizable = ExpressionTraits<LhsExpr>::vectorizable;
+    static constexpr size_t static_size = 0;
+    static constexpr size_t components = 1;
+};
+
+namespace detail {
+
+template<typename T, size_t K>
+struct OperandStorage<Batch<T, K>> {
+    using type = const Batch<T, K>&;
+};
+
+// 赋值内核：每次取 N 个实体的全部分量，逐个分量存回；不足 N 个的实体用单通道packet。
+// 标量路径同样使用单通道packet，与矩阵乘法的内核一样保持同一套代码
+struct BatchAssignKernel {
+    template<size_t Bytes, typename T, typename Expr>
+    static ET_ALWAYS_INLINE void run(T* dst, size_t stride, const Expr& expr, size_t begin,
+                                     size_t end) {
+        constexpr size_t N = Bytes == 0 ? 1 : Bytes / sizeof(T);
+        size_t e = begin;
+        for (; e + N <= end; e += N) {
+            store(dst + e, stride, expr.template packet<N>(e));
+        }
+        for (; e < end; ++e) {
+            store(dst + e, stride, expr.template packet<1>(e));
+        }
+    }
+
+private:
+    template<typename T, size_t N, size_t K>
+    static ET_ALWAYS_INLINE void store(T* dst, size_t stride,
+                                       const ComponentPackets<T, N, K>& values) {
+        for (size_t k = 0; k < K; ++k) {
+            values[k].store(dst + k * stride);
+        }
+    }
+};
+
+// 计算 [0, count) 的全部实体；并行时按实体分块，块的起点按缓存行取整，
+// 相邻线程不会写同一分量的同一缓存行
+template<typename T, typename Expr>
+void evaluateBatch(T* dst, size_t stride, const Expr& expr, size_t count, bool parallelize) {
+    constexpr size_t K = batch_components_v<Expr>;
+    ThreadPool& pool = ThreadPool::instance();
+    if (!parallelize || count * K < parallelThreshold() || pool.workerCount() == 0) {
+        simdDispatch<BatchAssignKernel>(dst, stride, expr, size_t(0), count);
+        return;
+    }
+    constexpr size_t line = 64 / sizeof(T) > 0 ? 64 / sizeof(T) : 1;
+    const size_t chunk = (std::max(parallelChunkSize<T>() / K, line) + line - 1) / line * line;
+    const size_t chunks = (count + chunk - 1) / chunk;
+    pool.run(chunks, [&](size_t c) {
+        const size_t begin = c * chunk;
+        simdDispatch<BatchAssignKernel>(dst, stride, expr, begin, std::min(count, begin + chunk));
+    });
+}
+
+// 批量表达式的两个操作数必须有相同的实体数
+inline size_t matchCounts(size_t lhs, size_t rhs) {
+    if (lhs != rhs) {
+        throw std::invalid_argument("批量大小不匹配");
+    }
+    return lhs;
+}
+
+} // namespace detail
+
+// ========================
+// 批量表达式基类
+// ========================
+// 派生类提供：
+//   count()          实体数
+//   packet<N>(e)     实体 [e, e + N) 的全部分量（ComponentPackets）
+//   aliasing(dst)    与赋值目标的重叠关系
+template<typename Derived>
+class BatchExpression {
+public:
+    using value_type = expression_value_t<Derived>;
+
+    static constexpr size_t components = detail::batch_components_v<Derived>;
+
+    size_t count() const {
+        return static_cast<const Derived&>(*this).count();
+    }
+
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return static_cast<const Derived&>(*this).aliasing(dst);
+    }
+};
+
+// ========================
+// 批量容器
+// ========================
+template<typename T, size_t K>
+class Batch : public BatchExpression<Batch<T, K>> {
+public:
+    static_assert(K >= 1, "每个实体至少有一个分量");
+    static_assert(detail::is_packet_type<T>, "批量容器只支持可以装入SIMD寄存器的算术类型");
+
+    using value_type = T;
+
+    static constexpr size_t components = K;
+
+    Batch() = default;
+
+    explicit Batch(size_t count) : Batch(count, T()) {}
+
+    // 每个实体的每个分量都是 value
+    Batch(size_t count, T value) : Batch(count, uninitialized) {
+        for (size_t k = 0; k < K; ++k) {
+            std::fill(component(k), component(k) + count_, value);
+        }
+    }
+
+    // 不初始化元素的构造函数，调用者负责随后写入全部元素
+    Batch(size_t count, UninitializedTag) {
+        resizeForOverwrite(count);
+    }
+
+    template<typename Expr>
+    Batch(const BatchExpression<Expr>& expr) : Batch(expr.count(), uninitialized) {
+        requireComponents<Expr>();
+        detail::evaluateBatch(data_.data(), stride_, static_cast<const Expr&>(expr), count_, false);
+    }
+
+    // 从表达式赋值，实体数改变且表达式读取目标自身时先求值到临时容器
+    template<typename Expr>
+    Batch& operator=(const BatchExpression<Expr>& expr) {
+        if (needsTemporary(expr)) {
+            Batch temp(expr);
+            swap(temp);
+            return *this;
+        }
+        return assignDirect(expr, false);
+    }
+
+    template<typename Expr>
+    Batch& assign(const BatchExpression<Expr>& expr) {
+        return *this = expr;
+    }
+
+    // 并行赋值：实体分块交给线程池，每块仍在实体方向上按SIMD求值
+    template<typename Expr>
+    Batch& assign(const BatchExpression<Expr>& expr, ParallelTag) {
+        if (needsTemporary(expr)) {
+            Batch temp(expr.count(), uninitialized);
+            temp.assignDirect(expr, true);
+            swap(temp);
+            return *this;
+        }
+        return assignDirect(expr, true);
+    }
+
+    // 条款25: 考虑写出一个不抛异常的swap函数
+    void swap(Batch& other) noexcept {
+        data_.swap(other.data_);
+        std::swap(count_, other.count_);
+        std::swap(stride_, other.stride_);
+    }
+
+    // 第 e 个实体的第 k 个分量
+    T& operator()(size_t e, size_t k) {
+        return data_[k * stride_ + e];
+    }
+
+    const T& operator()(size_t e, size_t k) const {
+        return data_[k * stride_ + e];
+    }
+
+    // 第 e 个实体的全部分量
+    std::array<T, K> get(size_t e) const {
+        std::array<T, K> values;
+        for (size_t k = 0; k < K; ++k) {
+            values[k] = (*this)(e, k);
+        }
+        return values;
+    }
+
+    void set(size_t e, const std::array<T, K>& values) {
+        for (size_t k = 0; k < K; ++k) {
+            (*this)(e, k) = values[k];
+        }
+    }
+
+    // 第 k 个分量的 count() 个值
+    T* component(size_t k) {
+        return data_.data() + k * stride_;
+    }
+
+    const T* component(size_t k) const {
+        return data_.data() + k * stride_;
+    }
+
+    size_t count() const {
+        return count_;
+    }
+
+    // 相邻分量之间的元素数：count() 按缓存行取整，每个分量都从缓存行的起点开始
+    size_t stride() const {
+        return stride_;
+    }
+
+    template<size_t N>
+    ET_ALWAYS_INLINE detail::ComponentPackets<T, N, K> packet(size_t e) const {
+        detail::ComponentPackets<T, N, K> values;
+        for (size_t k = 0; k < K; ++k) {
+            values[k] = Packet<T, N>::load(data_.data() + k * stride_ + e);
+        }
+        return values;
+    }
+
+    // 改变实体数，不保证保留任何元素的值
+    void resizeForOverwrite(size_t count) {
+        constexpr size_t line = 64 / sizeof(T) > 0 ? 64 / sizeof(T) : 1;
+        stride_ = (count + line - 1) / line * line;
+        count_ = count;
+        data_.resizeForOverwrite(K * stride_);
+    }
+
+    detail::MemoryRegion region() const {
+        return detail::regionOf(data_.data(), data_.size());
+    }
+
+    // 求值时每个实体只读取自己的分量，与目标是同一个容器时逐元素重叠
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return detail::leafAliasing(data_.data(), data_.size(), dst);
+    }
+
+private:
+    template<typename Expr>
+    static constexpr void requireComponents() {
+        static_assert(std::is_same_v<expression_value_t<Expr>, T>, "表达式与批量容器的元素类型不同");
+        static_assert(detail::batch_components_v<Expr> == K, "表达式与批量容器的分量数不同");
+    }
+
+    template<typename Expr>
+    bool needsTemporary(const BatchExpression<Expr>& expr) const {
+        detail::AliasKind kind = expr.aliasing(region());
+        return kind == detail::AliasKind::Overlap ||
+               (kind != detail::AliasKind::None && expr.count() != count_);
+    }
+
+    template<typename Expr>
+    Batch& assignDirect(const BatchExpression<Expr>& expr, bool parallelize) {
+        requireComponents<Expr>();
+        if (expr.count() != count_) {
+            resizeForOverwrite(expr.count());
+        }
+        detail::evaluateBatch(data_.data(), stride_, static_cast<const Expr&>(expr), count_,
+                              parallelize);
+        return *this;
+    }
+
+    AlignedBuffer<T> data_;
+    size_t count_ = 0;
+    size_t stride_ = 0;
+};
+
+// ========================
+// 批量运算
+// ========================
+// 逐元素的二元运算：分量数为1的一方广播到另一方的每个分量
+template<typename LhsExpr, typename RhsExpr, typename Op>
+class BatchBinaryOp : public BatchExpression<BatchBinaryOp<LhsExpr, RhsExpr, Op>> {
+public:
+    using value_type = expression_value_t<BatchBinaryOp>;
+
+    static constexpr size_t components = detail::batch_components_v<BatchBinaryOp>;
+
+    static_assert(std::is_same_v<expression_value_t<LhsExpr>, expression_value_t<RhsExpr>>,
+                  "批量表达式的两个操作数必须是同一元素类型");
+
+    BatchBinaryOp(const BatchExpression<LhsExpr>& lhs, const BatchExpression<RhsExpr>& rhs)
+        : lhs_(static_cast<const LhsExpr&>(lhs)), rhs_(static_cast<const RhsExpr&>(rhs)),
+          count_(detail::matchCounts(lhs_.count(), rhs_.count())) {}
+
+    size_t count() const {
+        return count_;
+    }
+
+    template<size_t N>
+    ET_ALWAYS_INLINE detail::ComponentPackets<value_type, N, components> packet(size_t e) const {
+        constexpr size_t lhsComponents = detail::batch_components_v<LhsExpr>;
+        constexpr size_t rhsComponents = detail::batch_components_v<RhsExpr>;
+        const auto lhs = lhs_.template packet<N>(e);
+        const auto rhs = rhs_.template packet<N>(e);
+        detail::ComponentPackets<value_type, N, components> values;
+        for (size_t k = 0; k < components; ++k) {
+            values[k] = Op::applyPacket(lhs[lhsComponents == 1 ? 0 : k],
+                                        rhs[rhsComponents == 1 ? 0 : k]);
+        }
+        return values;
+    }
+
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return detail::combineAlias(lhs_.aliasing(dst), rhs_.aliasing(dst));
+    }
+
+private:
+    detail::operand_t<LhsExpr> lhs_;
+    detail::operand_t<RhsExpr> rhs_;
+    size_t count_;
+};
+
+// 逐元素的一元运算，复用 SimdMath.hpp 中的运算
+template<typename Expr, typename Op>
+class BatchUnaryOp : public BatchExpression<BatchUnaryOp<Expr, Op>> {
+public:
+    using value_type = expression_value_t<BatchUnaryOp>;
+
+    static constexpr size_t components = detail::batch_components_v<Expr>;
+
+    static_assert(Op::template vectorizable<value_type> &&
+                      std::is_same_v<typename Op::template result_type<value_type>, value_type>,
+                  "批量表达式的一元运算必须有同类型的packet版本（浮点函数只支持float/double）");
+
+    explicit BatchUnaryOp(const BatchExpression<Expr>& expr)
+        : expr_(static_cast<const Expr&>(expr)) {}
+
+    size_t count() const {
+        return expr_.count();
+    }
+
+    template<size_t N>
+    ET_ALWAYS_INLINE detail::ComponentPackets<value_type, N, components> packet(size_t e) const {
+        detail::ComponentPackets<value_type, N, components> values = expr_.template packet<N>(e);
+        for (size_t k = 0; k < components; ++k) {
+            values[k] = Op::applyPacket(values[k]);
+        }
+        return values;
+    }
+
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return expr_.aliasing(dst);
+    }
+
+private:
+    detail::operand_t<Expr> expr_;
+};
+
+// 乘以标量，标量先转换为元素类型
+template<typename Expr>
+class BatchScaled : public BatchExpression<BatchScaled<Expr>> {
+public:
+    using value_type = expression_value_t<BatchScaled>;
+
+    static constexpr size_t components = detail::batch_components_v<Expr>;
+
+    BatchScaled(const BatchExpression<Expr>& expr, value_type scalar)
+        : expr_(static_cast<const Expr&>(expr)), scalar_(scalar) {}
+
+    size_t count() const {
+        return expr_.count();
+    }
+
+    template<size_t N>
+    ET_ALWAYS_INLINE detail::ComponentPackets<value_type, N, components> packet(size_t e) const {
+        detail::ComponentPackets<value_type, N, components> values = expr_.template packet<N>(e);
+        const Packet<value_type, N> scalar = Packet<value_type, N>::broadcast(scalar_);
+        for (size_t k = 0; k < components; ++k) {
+            values[k] = values[k] * scalar;
+        }
+        return values;
+    }
+
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return expr_.aliasing(dst);
+    }
+
+private:
+    detail::operand_t<Expr> expr_;
+    value_type scalar_;
+};
+
+// 每个实体的点积：结果只有一个分量，分量之间按固定顺序累加，与逐个向量计算的结果一致
+template<typename LhsExpr, typename RhsExpr>
+class BatchDot : public BatchExpression<BatchDot<LhsExpr, RhsExpr>> {
+public:
+    using value_type = expression_value_t<BatchDot>;
+
+    static constexpr size_t components = 1;
+
+    static_assert(std::is_same_v<expression_value_t<LhsExpr>, expression_value_t<RhsExpr>>,
+                  "批量表达式的两个操作数必须是同一元素类型");
+    static_assert(detail::batch_components_v<LhsExpr> == detail::batch_components_v<RhsExpr>,
+                  "点积的两个操作数必须有相同的分量数");
+
+    BatchDot(const BatchExpression<LhsExpr>& lhs, const BatchExpression<RhsExpr>& rhs)
+        : lhs_(static_cast<const LhsExpr&>(lhs)), rhs_(static_cast<const RhsExpr&>(rhs)),
+          count_(detail::matchCounts(lhs_.count(), rhs_.count())) {}
+
+    size_t count() const {
+        return count_;
+    }
+
+    template<size_t N>
+    ET_ALWAYS_INLINE detail::ComponentPackets<value_type, N, 1> packet(size_t e) const {
+        const auto lhs = lhs_.template packet<N>(e);
+        const auto rhs = rhs_.template packet<N>(e);
+        Packet<value_type, N> total = lhs[0] * rhs[0];
+        for (size_t k = 1; k < detail::batch_components_v<LhsExpr>; ++k) {
+            total = total + lhs[k] * rhs[k];
+        }
+        return {total};
+    }
+
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return detail::combineAlias(lhs_.aliasing(dst), rhs_.aliasing(dst));
+    }
+
+private:
+    detail::operand_t<LhsExpr> lhs_;
+    detail::operand_t<RhsExpr> rhs_;
+    size_t count_;
+};
+
+template<typename LhsExpr, typename RhsExpr>
+BatchBinaryOp<LhsExpr, RhsExpr, detail::AddOp> operator+(const BatchExpression<LhsExpr>& lhs,
+                                                         const BatchExpression<RhsExpr>& rhs) {
+    return BatchBinaryOp<LhsExpr, RhsExpr, detail::AddOp>(lhs, rhs);
+}
+
+template<typename LhsExpr, typename RhsExpr>
+BatchBinaryOp<LhsExpr, RhsExpr, detail::SubtractOp> operator-(const BatchExpression<LhsExpr>& lhs,
+                                                              const BatchExpression<RhsExpr>& rhs) {
+    return BatchBinaryOp<LhsExpr, RhsExpr, detail::SubtractOp>(lhs, rhs);
+}
+
+template<typename LhsExpr, typename RhsExpr>
+BatchBinaryOp<LhsExpr, RhsExpr, detail::MultiplyOp> operator*(const BatchExpression<LhsExpr>& lhs,
+                                                              const BatchExpression<RhsExpr>& rhs) {
+    return BatchBinaryOp<LhsExpr, RhsExpr, detail::MultiplyOp>(lhs, rhs);
+}
+
+template<typename LhsExpr, typename RhsExpr>
+BatchBinaryOp<LhsExpr, RhsExpr, detail::DivideOp> operator/(const BatchExpression<LhsExpr>& lhs,
+                                                            const BatchExpression<RhsExpr>& rhs) {
+    return BatchBinaryOp<LhsExpr, RhsExpr, detail::DivideOp>(lhs, rhs);
+}
+
+template<typename LhsExpr, typename RhsExpr>
+BatchBinaryOp<LhsExpr, RhsExpr, detail::MinimumOp> min(const BatchExpression<LhsExpr>& lhs,
+                                                       const BatchExpression<RhsExpr>& rhs) {
+    return BatchBinaryOp<LhsExpr, RhsExpr, detail::MinimumOp>(lhs, rhs);
+}
+
+template<typename LhsExpr, typename RhsExpr>
+BatchBinaryOp<LhsExpr, RhsExpr, detail::MaximumOp> max(const BatchExpression<LhsExpr>& lhs,
+                                                       const BatchExpression<RhsExpr>& rhs) {
+    return BatchBinaryOp<LhsExpr, RhsExpr, detail::MaximumOp>(lhs, rhs);
+}
+
+template<typename Expr, typename Scalar,
+         typename = std::enable_if_t<std::is_arithmetic_v<Scalar>>>
+BatchScaled<Expr> operator*(const BatchExpression<Expr>& expr, Scalar scalar) {
+    return BatchScaled<Expr>(expr, static_cast<expression_value_t<Expr>>(scalar));
+}
+
+template<typename Expr, typename Scalar,
+         typename = std::enable_if_t<std::is_arithmetic_v<Scalar>>>
+BatchScaled<Expr> operator*(Scalar scalar, const BatchExpression<Expr>& expr) {
+    return BatchScaled<Expr>(expr, static_cast<expression_value_t<Expr>>(scalar));
+}
+
+template<typename Expr>
+BatchUnaryOp<Expr, detail::SqrtOp> sqrt(const BatchExpression<Expr>& expr) {
+    return BatchUnaryOp<Expr, detail::SqrtOp>(expr);
+}
+
+template<typename Expr>
+BatchUnaryOp<Expr, detail::AbsOp> abs(const BatchExpression<Expr>& expr) {
+    return BatchUnaryOp<Expr, detail::AbsOp>(expr);
+}
+
+template<typename Expr>
+BatchUnaryOp<Expr, detail::SquareOp> square(const BatchExpression<Expr>& expr) {
+    return BatchUnaryOp<Expr, detail::SquareOp>(expr);
+}
+
+template<typename Expr>
+BatchUnaryOp<Expr, detail::ExpOp> exp(const BatchExpression<Expr>& expr) {
+    return BatchUnaryOp<Expr, detail::ExpOp>(expr);
+}
+
+template<typename Expr>
+BatchUnaryOp<Expr, detail::LogOp> log(const BatchExpression<Expr>& expr) {
+    return BatchUnaryOp<Expr, detail::LogOp>(expr);
+}
+
+template<typename Expr>
+BatchUnaryOp<Expr, detail::TanhOp> tanh(const BatchExpression<Expr>& expr) {
+    return BatchUnaryOp<Expr, detail::TanhOp>(expr);
+}
+
+template<typename LhsExpr, typename RhsExpr>
+BatchDot<LhsExpr, RhsExpr> dot(const BatchExpression<LhsExpr>& lhs,
+                               const BatchExpression<RhsExpr>& rhs) {
+    return BatchDot<LhsExpr, RhsExpr>(lhs, rhs);
+}
+
+// 每个实体的欧几里得范数
+template<typename Expr>
+BatchUnaryOp<BatchDot<Expr, Expr>, detail::SqrtOp> norm2(const BatchExpression<Expr>& expr) {
+    return BatchUnaryOp<BatchDot<Expr, Expr>, detail::SqrtOp>(BatchDot<Expr, Expr>(expr, expr));
+}
+
+// 打印前几个实体，每个实体的分量放在一对括号里
+template<typename T, size_t K>
+void printBatch(const Batch<T, K>& batch, const std::string& name, size_t maxDisplay = 4) {
+    std::cout << name << " (" << batch.count() << "x" << K << ") = [";
+    for (size_t e = 0; e < batch.count() && e < maxDisplay; ++e) {
+        if (e > 0) std::cout << ", ";
+        std::cout << "(";
+        for (size_t k = 0; k < K; ++k) {
+            if (k > 0) std::cout << ", ";
+            std::cout << batch(e, k);
+        }
+        std::cout << ")";
+    }
+    if (batch.count() > maxDisplay) {
+        std::cout << ", ...";
+    }
+    std::cout << "]" << std::endl;
+}
+
+} // namespace ExpressionTemplates
+
+#endif // BATCH_HPP
@@ -0,0 +1,472 @@
+// ElementwiseOps.hpp
+#ifndef ELEMENTWISE_OPS_HPP
+#define ELEMENTWISE_OPS_HPP
+
+#include "ExpressionTemplates.hpp"
+
+namespace ExpressionTemplates {
+
+// ========================
+// 逐元素二元运算
+// ========================
+// 乘、除、min/max与比较的结构完全相同，只是对每个元素做的运算不同，
+// 因此共用一个节点，运算本身由Op策略类提供
+// 条款41: 了解隐式接口和编译期多态
+//   Op::result_type<T>      - 操作数为T时结果的类型
+//   Op::apply(a, b)         - 标量版本
+//   Op::applyPacket(a, b)   - packet版本
+template<typename LhsExpr, typename RhsExpr, typename Op>
+class VectorBinaryOp;
+
+template<typename MaskExpr, typename TrueExpr, typename FalseExpr>
+class VectorWhere;
+
+namespace detail {
+
+template<typename T, size_t StaticSize>
+class ScalarBroadcast;
+
+// 算术运算：结果与操作数同类型
+struct AddOp {
+    template<typename T>
+    using result_type = T;
+
+    template<typename T>
+    static T apply(T a, T b) {
+        return a + b;
+    }
+
+    template<typename P>
+    static ET_ALWAYS_INLINE P applyPacket(const P& a, const P& b) {
+        return a + b;
+    }
+};
+
+struct SubtractOp {
+    template<typename T>
+    using result_type = T;
+
+    template<typename T>
+    static T apply(T a, T b) {
+        return a - b;
+    }
+
+    template<typename P>
+    static ET_ALWAYS_INLINE P applyPacket(const P& a, const P& b) {
+        return a - b;
+    }
+};
+
+struct MultiplyOp {
+    template<typename T>
+    using result_type = T;
+
+    template<typename T>
+    static T apply(T a, T b) {
+        return a * b;
+    }
+
+    template<typename P>
+    static ET_ALWAYS_INLINE P applyPacket(const P& a, const P& b) {
+        return a * b;
+    }
+};
+
+struct DivideOp {
+    template<typename T>
+    using result_type = T;
+
+    template<typename T>
+    static T apply(T a, T b) {
+        return a / b;
+    }
+
+    template<typename P>
+    static ET_ALWAYS_INLINE P applyPacket(const P& a, const P& b) {
+        return a / b;
+    }
+};
+
+struct MinimumOp {
+    template<typename T>
+    using result_type = T;
+
+    template<typename T>
+    static T apply(T a, T b) {
+        return b < a ? b : a;
+    }
+
+    // 与标量版本相同的选择规则，NaN的处理方式也一致
+    template<typename P>
+    static ET_ALWAYS_INLINE P applyPacket(const P& a, const P& b) {
+        return select(b < a, b, a);
+    }
+};
+
+struct MaximumOp {
+    template<typename T>
+    using result_type = T;
+
+    template<typename T>
+    static T apply(T a, T b) {
+        return a < b ? b : a;
+    }
+
+    template<typename P>
+    static ET_ALWAYS_INLINE P applyPacket(const P& a, const P& b) {
+        return select(a < b, b, a);
+    }
+};
+
+// 比较运算：结果是掩码，真为1、假为0，
+// 因此 count(a > b) 就是满足条件的元素个数，any/all 也可以直接使用。
+// 掩码与元素同宽，sum(a > b) 在掩码类型中累加，只有元素不小于4字节时才能当作计数
+template<typename Compare>
+struct ComparisonOp {
+    template<typename T>
+    using result_type = mask_value_t<T>;
+
+    template<typename T>
+    static mask_value_t<T> apply(T a, T b) {
+        return Compare{}(a, b) ? 1 : 0;
+    }
+
+    template<typename P>
+    static ET_ALWAYS_INLINE auto applyPacket(const P& a, const P& b) {
+        return Compare{}(a, b);
+    }
+};
+
+using LessOp = ComparisonOp<std::less<>>;
+using LessEqualOp = ComparisonOp<std::less_equal<>>;
+using GreaterOp = ComparisonOp<std::greater<>>;
+using GreaterEqualOp = ComparisonOp<std::greater_equal<>>;
+using EqualOp = ComparisonOp<std::equal_to<>>;
+using NotEqualOp = ComparisonOp<std::not_equal_to<>>;
+
+template<typename MaskExpr, typename TrueExpr, typename FalseExpr>
+constexpr size_t whereStaticSize() {
+    combinedStaticSize<MaskExpr, TrueExpr>();
+    return combinedStaticSize<TrueExpr, FalseExpr>();
+}
+
+} // namespace detail
+
+template<typename LhsExpr, typename RhsExpr, typename Op>
+struct ExpressionTraits<VectorBinaryOp<LhsExpr, RhsExpr, Op>> {
+    using operand_type = detail::common_value_t<LhsExpr, RhsExpr>;
+    using value_type = typename Op::template result_type<operand_type>;
+    static constexpr bool vectorizable = ExpressionTraits<LhsExpr>::vectorizable &&
+                                         ExpressionTraits<RhsExpr>::vectorizable &&
+                                         detail::is_packet_type<operand_type> &&
+                                         detail::is_packet_type<value_type>;
+    static constexpr size_t static_size = detail::combinedStaticSize<LhsExpr, RhsExpr>();
+};
+
+template<typename MaskExpr, typename TrueExpr, typename FalseExpr>
+struct ExpressionTraits<VectorWhere<MaskExpr, TrueExpr, FalseExpr>> {
+    using value_type = detail::common_value_t<TrueExpr, FalseExpr>;
+    static constexpr bool vectorizable = ExpressionTraits<MaskExpr>::vectorizable &&
+                                         ExpressionTraits<TrueExpr>::vectorizable &&
+                                         ExpressionTraits<FalseExpr>::vectorizable &&
+                                         detail::is_packet_type<value_type>;
+    static constexpr size_t static_size =
+        detail::whereStaticSize<MaskExpr, TrueExpr, FalseExpr>();
+};
+
+template<typename T, size_t StaticSize>
+struct ExpressionTraits<detail::ScalarBroadcast<T, StaticSize>> {
+    using value_type = T;
+    static constexpr bool vectorizable = detail::is_packet_type<T>;
+    static constexpr size_t static_size = StaticSize;
+};
+
+template<typename LhsExpr, typename RhsExpr, typename Op>
+class VectorBinaryOp : public VectorExpression<VectorBinaryOp<LhsExpr, RhsExpr, Op>> {
+public:
+    using value_type = expression_value_t<VectorBinaryOp>;
+    using operand_type = typename ExpressionTraits<VectorBinaryOp>::operand_type;
+
+    VectorBinaryOp(const VectorExpression<LhsExpr>& lhs, const VectorExpression<RhsExpr>& rhs)
+        : lhs_(static_cast<const LhsExpr&>(lhs)),
+          rhs_(static_cast<const RhsExpr&>(rhs)) {
+        detail::requireSameSize(lhs_, rhs_);
+    }
+
+    value_type operator[](size_t i) const {
+        return Op::apply(static_cast<operand_type>(lhs_[i]), static_cast<operand_type>(rhs_[i]));
+    }
+
+    template<size_t N>
+    ET_ALWAYS_INLINE Packet<value_type, N> packet(size_t i) const {
+        return Op::applyPacket(detail::packetAs<operand_type, LhsExpr, N>(lhs_, i),
+                               detail::packetAs<operand_type, RhsExpr, N>(rhs_, i));
+    }
+
+    size_t size() const {
+        return lhs_.size();
+    }
+
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return detail::combineAlias(lhs_.aliasing(dst), rhs_.aliasing(dst));
+    }
+
+    template<typename F>
+    void forEachStream(F& f) const {
+        detail::forEachStream(lhs_, f);
+        detail::forEachStream(rhs_, f);
+    }
+
+private:
+    detail::operand_t<LhsExpr> lhs_;
+    detail::operand_t<RhsExpr> rhs_;
+};
+
+namespace detail {
+
+// 把标量当作所有元素都相同的向量，用于 a > 0.0、max(a, 0.0) 一类的写法；
+// 长度与另一个操作数相同，编译期长度也随之而定，不影响定长向量的大小检查
+template<typename T, size_t StaticSize>
+class ScalarBroadcast : public VectorExpression<ScalarBroadcast<T, StaticSize>> {
+public:
+    using value_type = T;
+
+    ScalarBroadcast(T value, size_t size) : value_(value), size_(size) {}
+
+    value_type operator[](size_t) const {
+        return value_;
+    }
+
+    template<size_t N>
+    ET_ALWAYS_INLINE Packet<T, N> packet(size_t) const {
+        return Packet<T, N>::broadcast(value_);
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    AliasKind aliasing(const MemoryRegion&) const {
+        return AliasKind::None;
+    }
+
+private:
+    T value_;
+    size_t size_;
+};
+
+// 与表达式expr搭配的标量，类型规则与 expr * scalar 相同
+template<typename Expr, typename Scalar>
+auto broadcastLike(const VectorExpression<Expr>& expr, Scalar scalar) {
+    using T = scaled_value_t<expression_value_t<Expr>, Scalar>;
+    return ScalarBroadcast<T, ExpressionTraits<Expr>::static_size>(static_cast<T>(scalar),
+                                                                 expr.size());
+}
+
+template<typename Scalar>
+using enable_if_scalar_t = std::enable_if_t<std::is_arithmetic_v<Scalar>>;
+
+} // namespace detail
+
+// 逐元素乘法（向量 * 向量）
+template<typename LhsExpr, typename RhsExpr>
+VectorBinaryOp<LhsExpr, RhsExpr, detail::MultiplyOp> operator*(
+    const VectorExpression<LhsExpr>& lhs,
+    const VectorExpression<RhsExpr>& rhs) {
+    return VectorBinaryOp<LhsExpr, RhsExpr, detail::MultiplyOp>(lhs, rhs);
+}
+
+// 逐元素除法（向量 / 向量）
+template<typename LhsExpr, typename RhsExpr>
+VectorBinaryOp<LhsExpr, RhsExpr, detail::DivideOp> operator/(
+    const VectorExpression<LhsExpr>& lhs,
+    const VectorExpression<RhsExpr>& rhs) {
+    return VectorBinaryOp<LhsExpr, RhsExpr, detail::DivideOp>(lhs, rhs);
+}
+
+// 逐元素最小值/最大值（与单参数的归约版本 min(expr)/max(expr) 区分）
+template<typename LhsExpr, typename RhsExpr>
+VectorBinaryOp<LhsExpr, RhsExpr, detail::MinimumOp> min(
+    const VectorExpression<LhsExpr>& lhs,
+    const VectorExpression<RhsExpr>& rhs) {
+    return VectorBinaryOp<LhsExpr, RhsExpr, detail::MinimumOp>(lhs, rhs);
+}
+
+template<typename LhsExpr, typename RhsExpr>
+VectorBinaryOp<LhsExpr, RhsExpr, detail::MaximumOp> max(
+    const VectorExpression<LhsExpr>& lhs,
+    const VectorExpression<RhsExpr>& rhs) {
+    return VectorBinaryOp<LhsExpr, RhsExpr, detail::MaximumOp>(lhs, rhs);
+}
+
+// 与标量比较的最小值/最大值，例如 max(a, 0.0)
+template<typename Expr, typename Scalar, typename = detail::enable_if_scalar_t<Scalar>>
+auto min(const VectorExpression<Expr>& expr, Scalar scalar) {
+    return min(expr, detail::broadcastLike(expr, scalar));
+}
+
+template<typename Expr, typename Scalar, typename = detail::enable_if_scalar_t<Scalar>>
+auto max(const VectorExpression<Expr>& expr, Scalar scalar) {
+    return max(expr, detail::broadcastLike(expr, scalar));
+}
+
+// ========================
+// 比较运算，结果为掩码表达式
+// ========================
+template<typename LhsExpr, typename RhsExpr>
+VectorBinaryOp<LhsExpr, RhsExpr, detail::LessOp> operator<(
+    const VectorExpression<LhsExpr>& lhs,
+    const VectorExpression<RhsExpr>& rhs) {
+    return VectorBinaryOp<LhsExpr, RhsExpr, detail::LessOp>(lhs, rhs);
+}
+
+template<typename LhsExpr, typename RhsExpr>
+VectorBinaryOp<LhsExpr, RhsExpr, detail::LessEqualOp> operator<=(
+    const VectorExpression<LhsExpr>& lhs,
+    const VectorExpression<RhsExpr>& rhs) {
+    return VectorBinaryOp<LhsExpr, RhsExpr, detail::LessEqualOp>(lhs, rhs);
+}
+
+template<typename LhsExpr, typename RhsExpr>
+VectorBinaryOp<LhsExpr, RhsExpr, detail::GreaterOp> operator>(
+    const VectorExpression<LhsExpr>& lhs,
+    const VectorExpression<RhsExpr>& rhs) {
+    return VectorBinaryOp<LhsExpr, RhsExpr, detail::GreaterOp>(lhs, rhs);
+}
+
+template<typename LhsExpr, typename RhsExpr>
+VectorBinaryOp<LhsExpr, RhsExpr, detail::GreaterEqualOp> operator>=(
+    const VectorExpression<LhsExpr>& lhs,
+    const VectorExpression<RhsExpr>& rhs) {
+    return VectorBinaryOp<LhsExpr, RhsExpr, detail::GreaterEqualOp>(lhs, rhs);
+}
+
+template<typename LhsExpr, typename RhsExpr>
+VectorBinaryOp<LhsExpr, RhsExpr, detail::EqualOp> operator==(
+    const VectorExpression<LhsExpr>& lhs,
+    const VectorExpression<RhsExpr>& rhs) {
+    return VectorBinaryOp<LhsExpr, RhsExpr, detail::EqualOp>(lhs, rhs);
+}
+
+template<typename LhsExpr, typename RhsExpr>
+VectorBinaryOp<LhsExpr, RhsExpr, detail::NotEqualOp> operator!=(
+    const VectorExpression<LhsExpr>& lhs,
+    const VectorExpression<RhsExpr>& rhs) {
+    return VectorBinaryOp<LhsExpr, RhsExpr, detail::NotEqualOp>(lhs, rhs);
+}
+
+// 与标量比较，例如 a > 0.0
+template<typename Expr, typename Scalar, typename = detail::enable_if_scalar_t<Scalar>>
+auto operator<(const VectorExpression<Expr>& expr, Scalar scalar) {
+    return expr < detail::broadcastLike(expr, scalar);
+}
+
+template<typename Expr, typename Scalar, typename = detail::enable_if_scalar_t<Scalar>>
+auto operator<=(const VectorExpression<Expr>& expr, Scalar scalar) {
+    return expr <= detail::broadcastLike(expr, scalar);
+}
+
+template<typename Expr, typename Scalar, typename = detail::enable_if_scalar_t<Scalar>>
+auto operator>(const VectorExpression<Expr>& expr, Scalar scalar) {
+    return expr > detail::broadcastLike(expr, scalar);
+}
+
+template<typename Expr, typename Scalar, typename = detail::enable_if_scalar_t<Scalar>>
+auto operator>=(const VectorExpression<Expr>& expr, Scalar scalar) {
+    return expr >= detail::broadcastLike(expr, scalar);
+}
+
+template<typename Expr, typename Scalar, typename = detail::enable_if_scalar_t<Scalar>>
+auto operator==(const VectorExpression<Expr>& expr, Scalar scalar) {
+    return expr == detail::broadcastLike(expr, scalar);
+}
+
+template<typename Expr, typename Scalar, typename = detail::enable_if_scalar_t<Scalar>>
+auto operator!=(const VectorExpression<Expr>& expr, Scalar scalar) {
+    return expr != detail::broadcastLike(expr, scalar);
+}
+
+// ========================
+// 按掩码选择
+// ========================
+// where(mask, x, y)[i] = mask[i] != 0 ? x[i] : y[i]
+// 两个分支都会被求值（与SIMD的blend一样），因此分支里不应有副作用
+template<typename MaskExpr, typename TrueExpr, typename FalseExpr>
+class VectorWhere : public VectorExpression<VectorWhere<MaskExpr, TrueExpr, FalseExpr>> {
+public:
+    using value_type = expression_value_t<VectorWhere>;
+
+    VectorWhere(const VectorExpression<MaskExpr>& mask,
+                const VectorExpression<TrueExpr>& whenTrue,
+                const VectorExpression<FalseExpr>& whenFalse)
+        : mask_(static_cast<const MaskExpr&>(mask)),
+          whenTrue_(static_cast<const TrueExpr&>(whenTrue)),
+          whenFalse_(static_cast<const FalseExpr&>(whenFalse)) {
+        detail::requireSameSize(mask_, whenTrue_);
+        detail::requireSameSize(whenTrue_, whenFalse_);
+    }
+
+    value_type operator[](size_t i) const {
+        return mask_[i] != 0 ? static_cast<value_type>(whenTrue_[i])
+                             : static_cast<value_type>(whenFalse_[i]);
+    }
+
+    // 掩码先在自身类型上与0比较，再换成与结果同宽的掩码，
+    // 任意数值表达式都能当掩码使用，结果与标量版本一致
+    template<size_t N>
+    ET_ALWAYS_INLINE Packet<value_type, N> packet(size_t i) const {
+        using M = expression_value_t<MaskExpr>;
+        auto nonZero = mask_.template packet<N>(i) != Packet<M, N>::broadcast(M{});
+        return select(nonZero.template cast<detail::mask_value_t<value_type>>(),
+                      detail::packetAs<value_type, TrueExpr, N>(whenTrue_, i),
+                      detail::packetAs<value_type, FalseExpr, N>(whenFalse_, i));
+    }
+
+    size_t size() const {
+        return mask_.size();
+    }
+
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return detail::combineAlias(mask_.aliasing(dst),
+                                    detail::combineAlias(whenTrue_.aliasing(dst),
+                                                         whenFalse_.aliasing(dst)));
+    }
+
+    template<typename F>
+    void forEachStream(F& f) const {
+        detail::forEachStream(mask_, f);
+        detail::forEachStream(whenTrue_, f);
+        detail::forEachStream(whenFalse_, f);
+    }
+
+private:
+    detail::operand_t<MaskExpr> mask_;
+    detail::operand_t<TrueExpr> whenTrue_;
+    detail::operand_t<FalseExpr> whenFalse_;
+};
+
+template<typename MaskExpr, typename TrueExpr, typename FalseExpr>
+VectorWhere<MaskExpr, TrueExpr, FalseExpr> where(const VectorExpression<MaskExpr>& mask,
+                                                 const VectorExpression<TrueExpr>& whenTrue,
+                                                 const VectorExpression<FalseExpr>& whenFalse) {
+    return VectorWhere<MaskExpr, TrueExpr, FalseExpr>(mask, whenTrue, whenFalse);
+}
+
+// 分支为标量，例如 where(a > 0.0, a, 0.0)
+template<typename MaskExpr, typename TrueExpr, typename Scalar,
+         typename = detail::enable_if_scalar_t<Scalar>>
+auto where(const VectorExpression<MaskExpr>& mask,
+           const VectorExpression<TrueExpr>& whenTrue, Scalar whenFalse) {
+    return where(mask, whenTrue, detail::broadcastLike(whenTrue, whenFalse));
+}
+
+template<typename MaskExpr, typename Scalar, typename FalseExpr,
+         typename = detail::enable_if_scalar_t<Scalar>>
+auto where(const VectorExpression<MaskExpr>& mask,
+           Scalar whenTrue, const VectorExpression<FalseExpr>& whenFalse) {
+    return where(mask, detail::broadcastLike(whenFalse, whenTrue), whenFalse);
+}
+
+} // namespace ExpressionTemplates
+
+#endif // ELEMENTWISE_OPS_HPP
@@ -8,6 +8,19 @@
 #include <chrono>
 #include <iomanip>
 #include <functional>
+#include <type_traits>
+#include <array>
+#include <utility>
+#include <initializer_list>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "AlignedBuffer.hpp"
+#include "SimdPacket.hpp"
+#include "SimdMath.hpp"
+#include "ParallelEvaluation.hpp"
+#include "TiledEvaluation.hpp"
 
 namespace ExpressionTemplates {
 
@@ -18,32 +31,287 @@ namespace ExpressionTemplates {
 template<typename T>
 class Vector;
 
+template<typename T, size_t N>
+class StaticVector;
+
+namespace detail {
+template<typename Target>
+class NoAlias;
+}
+
+template<typename LhsExpr, typename RhsExpr>
+class VectorSum;
+
+template<typename LhsExpr, typename RhsExpr>
+class VectorDifference;
+
+template<typename Expr, typename Scalar>
+class VectorScaled;
+
+template<typename Expr, typename Func>
+class VectorApply;
+
+template<typename Expr, typename Op>
+class VectorUnaryOp;
+
+// ========================
+// 表达式特性
+// ========================
+// 条款47: 请使用traits classes表现类型信息
+// 每种节点在定义之前先特化ExpressionTraits，基类因此能在派生类
+// 尚不完整时得知它的值类型：
+//   value_type   - 节点求值结果的类型，由子节点的类型推导而来
+//   vectorizable - 整棵子树能否走packet求值路径
+//   static_size  - 编译期已知的长度，0 表示运行时才知道
+template<typename Expr>
+struct ExpressionTraits;
+
+template<typename Expr>
+using expression_value_t = typename ExpressionTraits<Expr>::value_type;
+
+namespace detail {
+
+// 两个子节点的公共值类型，例如 float + double 得到 double
+template<typename LhsExpr, typename RhsExpr>
+using common_value_t = std::common_type_t<expression_value_t<LhsExpr>,
+                                          expression_value_t<RhsExpr>>;
+
+// 浮点表达式乘以标量时保持表达式自身的精度（float * 2.0 仍是float），
+// 整数表达式则按常规算术转换（int * 2.5 得到double）
+template<typename T, typename Scalar>
+using scaled_value_t = std::conditional_t<std::is_floating_point_v<T>, T,
+                                          std::common_type_t<T, Scalar>>;
+
+// 两个子节点的编译期长度必须一致：定长与动态长度、或不同长度的定长向量混用都无法编译
+template<typename LhsExpr, typename RhsExpr>
+constexpr size_t combinedStaticSize() {
+    constexpr size_t lhs = ExpressionTraits<LhsExpr>::static_size;
+    constexpr size_t rhs = ExpressionTraits<RhsExpr>::static_size;
+    static_assert(lhs == rhs, "StaticVector不能与动态Vector或不同长度的StaticVector混合运算");
+    return lhs;
+}
+
+// 动态长度的表达式在运行时检查大小，定长表达式已在编译期检查过
+template<typename LhsExpr, typename RhsExpr>
+void requireSameSize(const LhsExpr& lhs, const RhsExpr& rhs) {
+    if constexpr (combinedStaticSize<LhsExpr, RhsExpr>() == 0) {
+        if (lhs.size() != rhs.size()) {
+            throw std::invalid_argument("向量大小不匹配");
+        }
+    }
+}
+
+// 节点保存子节点的方式：持有数据的叶子（Vector等）按引用保存，避免复制数据；
+// 中间节点只有几个引用和标量大小，按值保存，
+// 这样 auto e = a + b * 2.0; 中的临时节点 b * 2.0 被复制进 e，不会悬空
+template<typename Expr>
+struct OperandStorage {
+    using type = const Expr;
+};
+
+template<typename T>
+struct OperandStorage<Vector<T>> {
+    using type = const Vector<T>&;
+};
+
+template<typename T, size_t N>
+struct OperandStorage<StaticVector<T, N>> {
+    using type = const StaticVector<T, N>&;
+};
+
+template<typename Expr>
+using operand_t = typename OperandStorage<Expr>::type;
+
+// ========================
+// 别名分析
+// ========================
+// 赋值目标的内存区域：从first开始的count个元素，相邻元素相距stride字节
+struct MemoryRegion {
+    const void* first;
+    size_t count;
+    size_t elementBytes;
+    std::ptrdiff_t stride;
+};
+
+// 操作数与赋值目标的重叠关系，按严重程度排序
+enum class AliasKind {
+    None,         // 不重叠
+    Elementwise,  // 只在同一下标处重叠（a = a + b），直接写回是安全的
+    Overlap       // 错位重叠，直接写回会读到已被覆盖的元素
+};
+
+inline AliasKind combineAlias(AliasKind a, AliasKind b) {
+    return a < b ? b : a;
+}
+
+template<typename T>
+MemoryRegion regionOf(const T* data, size_t count) {
+    return MemoryRegion{data, count, sizeof(T), static_cast<std::ptrdiff_t>(sizeof(T))};
+}
+
+// 叶子节点读取 first, first + stride, ... 共count个元素（stride以元素计，可以为负），
+// 判断它与目标区域的关系
+template<typename T>
+AliasKind leafAliasing(const T* first, size_t count, std::ptrdiff_t stride,
+                       const MemoryRegion& dst) {
+    if (count == 0 || dst.count == 0) {
+        return AliasKind::None;
+    }
+    auto lo = [](std::uintptr_t first, std::ptrdiff_t stride, size_t n) {
+        return stride < 0 ? first + stride * static_cast<std::ptrdiff_t>(n - 1) : first;
+    };
+    auto hi = [](std::uintptr_t first, std::ptrdiff_t stride, size_t n, size_t bytes) {
+        return (stride < 0 ? first : first + stride * static_cast<std::ptrdiff_t>(n - 1)) + bytes;
+    };
+    std::uintptr_t src = reinterpret_cast<std::uintptr_t>(first);
+    std::uintptr_t out = reinterpret_cast<std::uintptr_t>(dst.first);
+    const std::ptrdiff_t srcStride = stride * static_cast<std::ptrdiff_t>(sizeof(T));
+    if (hi(src, srcStride, count, sizeof(T)) <= lo(out, dst.stride, dst.count) ||
+        hi(out, dst.stride, dst.count, dst.elementBytes) <= lo(src, srcStride, count)) {
+        return AliasKind::None;
+    }
+    if (src == out && sizeof(T) == dst.elementBytes && srcStride == dst.stride) {
+        return AliasKind::Elementwise;
+    }
+    return AliasKind::Overlap;
+}
+
+// 连续存储的叶子节点读取 data[0, count)
+template<typename T>
+AliasKind leafAliasing(const T* data, size_t count, const MemoryRegion& dst) {
+    return leafAliasing(data, count, 1, dst);
+}
+
+// 把子节点的packet转换为父节点的值类型
+template<typename T, typename Expr, size_t N>
+ET_ALWAYS_INLINE auto packetAs(const Expr& expr, size_t i) {
+    return expr.template packet<N>(i).template cast<T>();
+}
+
+} // namespace detail
+
+template<typename T>
+struct ExpressionTraits<Vector<T>> {
+    using value_type = T;
+    static constexpr bool vectorizable = detail::is_packet_type<T>;
+    static constexpr size_t static_size = 0;
+};
+
+template<typename T, size_t N>
+struct ExpressionTraits<StaticVector<T, N>> {
+    using value_type = T;
+    static constexpr bool vectorizable = detail::is_packet_type<T>;
+    static constexpr size_t static_size = N;
+};
+
+template<typename LhsExpr, typename RhsExpr>
+struct ExpressionTraits<VectorSum<LhsExpr, RhsExpr>> {
+    using value_type = detail::common_value_t<LhsExpr, RhsExpr>;
+    static constexpr bool vectorizable = ExpressionTraits<LhsExpr>::vectorizable &&
+                                         ExpressionTraits<RhsExpr>::vectorizable &&
+                                         detail::is_packet_type<value_type>;
+    static constexpr size_t static_size = detail::combinedStaticSize<LhsExpr, RhsExpr>();
+};
+
+template<typename LhsExpr, typename RhsExpr>
+struct ExpressionTraits<VectorDifference<LhsExpr, RhsExpr>>
+    : ExpressionTraits<VectorSum<LhsExpr, RhsExpr>> {};
+
+template<typename Expr, typename Scalar>
+struct ExpressionTraits<VectorScaled<Expr, Scalar>> {
+    using value_type = detail::scaled_value_t<expression_value_t<Expr>, Scalar>;
+    static constexpr bool vectorizable = ExpressionTraits<Expr>::vectorizable &&
+                                         detail::is_packet_type<value_type>;
+    static constexpr size_t static_size = ExpressionTraits<Expr>::static_size;
+};
+
+template<typename Expr, typename Func>
+struct ExpressionTraits<VectorApply<Expr, Func>> {
+    using value_type = std::decay_t<std::invoke_result_t<const Func&, expression_value_t<Expr>>>;
+    static constexpr bool vectorizable = ExpressionTraits<Expr>::vectorizable &&
+                                         detail::is_packet_type<value_type>;
+    static constexpr size_t static_size = ExpressionTraits<Expr>::static_size;
+};
+
+template<typename Expr, typename Op>
+struct ExpressionTraits<VectorUnaryOp<Expr, Op>> {
+    using operand_type = expression_value_t<Expr>;
+    using value_type = typename Op::template result_type<operand_type>;
+    static constexpr bool vectorizable = ExpressionTraits<Expr>::vectorizable &&
+                                         Op::template vectorizable<operand_type> &&
+                                         std::is_same_v<value_type, operand_type>;
+    static constexpr size_t static_size = ExpressionTraits<Expr>::static_size;
+};
+
 // ========================
 // 表达式模板基类，用于表示向量表达式
 // ========================
 template<typename Derived>
 class VectorExpression {
 public:
+    // 值类型由ExpressionTraits推导
+    using value_type = expression_value_t<Derived>;
+    
     // 重载operator[]，从派生类获取对应位置的元素
-    double operator[](size_t i) const {
+    value_type operator[](size_t i) const {
         return static_cast<const Derived&>(*this)[i];
     }
     
+    // 一次取出从i开始的N个元素，供SIMD求值路径使用
+    template<size_t N>
+    ET_ALWAYS_INLINE Packet<value_type, N> packet(size_t i) const {
+        return static_cast<const Derived&>(*this).template packet<N>(i);
+    }
+    
     // 获取表达式的大小
     size_t size() const {
         return static_cast<const Derived&>(*this).size();
     }
     
-    // 将表达式转换为实际的向量
-    operator Vector<double>() const;
+    // 表达式读取的内存与赋值目标的重叠关系
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return static_cast<const Derived&>(*this).aliasing(dst);
+    }
+    
+    // 将表达式转换为实际的向量，元素类型与表达式一致
+    operator Vector<value_type>() const;
+};
+
+namespace detail {
+
+// noalias() 返回的代理：赋值时不做别名检查，直接写入目标
+template<typename Target>
+class NoAlias {
+public:
+    explicit NoAlias(Target& target) : target_(target) {}
+    
+    template<typename Expr>
+    Target& operator=(const Expr& expr) {
+        return target_.assignDirect(expr);
+    }
+    
+    // policy 为 parallel 或 Tiling
+    template<typename Expr, typename Policy>
+    Target& assign(const Expr& expr, const Policy& policy) {
+        return target_.assignDirect(expr, policy);
+    }
+    
+private:
+    Target& target_;
 };
 
+} // namespace detail
+
 // ========================
 // 向量类，用于存储实际数据
 // ========================
 template<typename T>
 class Vector : public VectorExpression<Vector<T>> {
 public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+    
     // 默认构造函数
     Vector() = default;
     
@@ -53,22 +321,75 @@ public:
     // 带初始值的构造函数
     Vector(size_t size, T value) : data_(size, value) {}
     
+    // 不初始化元素的构造函数，调用者负责随后写入全部元素
+    Vector(size_t size, UninitializedTag) : data_(size, uninitialized) {}
+    
     // 从表达式构造向量
     template<typename Expr>
-    Vector(const VectorExpression<Expr>& expr) : data_(expr.size()) {
-        for (size_t i = 0; i < data_.size(); ++i) {
-            data_[i] = expr[i];
-        }
+    Vector(const VectorExpression<Expr>& expr) : data_(expr.size(), uninitialized) {
+        detail::evaluateRange(data_.data(), static_cast<const Expr&>(expr), 0, data_.size());
     }
     
     // 从表达式赋值
+    // 操作数与自身错位重叠时（例如读取自身的平移视图）先求值到临时缓冲区再交换，
+    // 不重叠或只在同一下标处重叠时直接写入
     template<typename Expr>
     Vector& operator=(const VectorExpression<Expr>& expr) {
-        data_.resize(expr.size());
-        for (size_t i = 0; i < data_.size(); ++i) {
-            data_[i] = expr[i];
+        if (needsTemporary(expr)) {
+            Vector temp(expr);
+            data_.swap(temp.data_);
+            return *this;
         }
-        return *this;
+        return assignDirect(expr);
+    }
+    
+    template<typename Expr>
+    Vector& assign(const VectorExpression<Expr>& expr) {
+        return *this = expr;
+    }
+    
+    // 并行赋值：按缓存友好的块分给线程池，小于阈值时回退为串行
+    template<typename Expr>
+    Vector& assign(const VectorExpression<Expr>& expr, ParallelTag) {
+        if (needsTemporary(expr)) {
+            Vector temp(expr.size(), uninitialized);
+            temp.assignDirect(expr, parallel);
+            data_.swap(temp.data_);
+            return *this;
+        }
+        return assignDirect(expr, parallel);
+    }
+    
+    // 分块求值，见 TiledEvaluation.hpp
+    template<typename Expr>
+    Vector& assign(const VectorExpression<Expr>& expr, const Tiling& tiling) {
+        if (needsTemporary(expr)) {
+            Vector temp(expr.size(), uninitialized);
+            temp.assignDirect(expr, tiling);
+            data_.swap(temp.data_);
+            return *this;
+        }
+        return assignDirect(expr, tiling);
+    }
+    
+    // 调用者保证表达式不与本向量错位重叠，跳过别名检查：
+    //   c.noalias() = a + b;
+    detail::NoAlias<Vector> noalias() {
+        return detail::NoAlias<Vector>(*this);
+    }
+    
+    // 本向量作为赋值目标时占用的内存
+    detail::MemoryRegion region() const {
+        return detail::regionOf(data_.data(), data_.size());
+    }
+    
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return detail::leafAliasing(data_.data(), data_.size(), dst);
+    }
+    
+    template<typename F>
+    void forEachStream(F& f) const {
+        f(data_.data(), static_cast<std::ptrdiff_t>(sizeof(T)));
     }
     
     // 访问元素
@@ -81,62 +402,275 @@ public:
         return data_[i];
     }
     
+    // 从连续存储中直接加载一个packet
+    template<size_t N>
+    ET_ALWAYS_INLINE Packet<T, N> packet(size_t i) const {
+        return Packet<T, N>::load(data_.data() + i);
+    }
+    
     // 获取大小
     size_t size() const {
         return data_.size();
     }
     
+    // 条款15: 在资源管理类中提供对原始资源的访问
+    T* data() {
+        return data_.data();
+    }
+    
+    const T* data() const {
+        return data_.data();
+    }
+    
+    // 把元素按内存中的原样写入二进制文件（没有文件头，本机字节序），
+    // 之后可以用 MappedVector<T> 直接映射，不必再读取和解析
+    void save(const std::string& path) const {
+        static_assert(std::is_trivially_copyable_v<T>, "只能保存可以按字节复制的元素类型");
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("无法写入文件: " + path);
+        }
+        out.write(reinterpret_cast<const char*>(data_.data()),
+                  static_cast<std::streamsize>(data_.size() * sizeof(T)));
+        if (!out) {
+            throw std::runtime_error("写入文件失败: " + path);
+        }
+    }
+    
     // 迭代器支持
-    typename std::vector<T>::iterator begin() {
+    iterator begin() {
         return data_.begin();
     }
     
-    typename std::vector<T>::iterator end() {
+    iterator end() {
         return data_.end();
     }
     
-    typename std::vector<T>::const_iterator begin() const {
+    const_iterator begin() const {
         return data_.begin();
     }
     
-    typename std::vector<T>::const_iterator end() const {
+    const_iterator end() const {
         return data_.end();
     }
     
 private:
-    std::vector<T> data_;
+    friend class detail::NoAlias<Vector>;
+    
+    // 目标会被重新分配（大小改变）时，任何重叠都需要临时缓冲区
+    template<typename Expr>
+    bool needsTemporary(const VectorExpression<Expr>& expr) const {
+        detail::AliasKind kind = expr.aliasing(region());
+        return kind == detail::AliasKind::Overlap ||
+               (kind != detail::AliasKind::None && expr.size() != data_.size());
+    }
+    
+    template<typename Expr>
+    Vector& assignDirect(const VectorExpression<Expr>& expr) {
+        data_.resizeForOverwrite(expr.size());
+        detail::evaluateRange(data_.data(), static_cast<const Expr&>(expr), 0, data_.size());
+        return *this;
+    }
+    
+    template<typename Expr>
+    Vector& assignDirect(const VectorExpression<Expr>& expr, ParallelTag) {
+        data_.resizeForOverwrite(expr.size());
+        detail::evaluateParallel(data_.data(), static_cast<const Expr&>(expr), data_.size());
+        return *this;
+    }
+    
+    template<typename Expr>
+    Vector& assignDirect(const VectorExpression<Expr>& expr, const Tiling& tiling) {
+        data_.resizeForOverwrite(expr.size());
+        detail::evaluateTiled(data_.data(), static_cast<const Expr&>(expr), data_.size(), tiling);
+        return *this;
+    }
+    
+    // 64字节对齐，表达式结果不做多余的初始化
+    AlignedBuffer<T> data_;
 };
 
-// 实现 VectorExpression::operator Vector<double>()
+// ========================
+// 定长向量，数据在栈上
+// ========================
+// 长度是类型的一部分：大小检查在编译期完成，赋值按下标完全展开，
+// 没有堆分配也没有运行时分派，适合数以百万计的3维、4维几何向量
+template<typename T, size_t N>
+class StaticVector : public VectorExpression<StaticVector<T, N>> {
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+    
+    // 元素初始化为0
+    StaticVector() : data_{} {}
+    
+    explicit StaticVector(T value) {
+        data_.fill(value);
+    }
+    
+    // 例如 StaticVector<double, 3> p{1.0, 2.0, 3.0}; 不足N个的元素为0
+    StaticVector(std::initializer_list<T> values) : data_{} {
+        if (values.size() > N) {
+            throw std::invalid_argument("初始值个数超过StaticVector的长度");
+        }
+        std::copy(values.begin(), values.end(), data_.begin());
+    }
+    
+    // 从表达式构造，表达式的长度必须在编译期等于N
+    template<typename Expr>
+    StaticVector(const VectorExpression<Expr>& expr) {
+        assign(static_cast<const Expr&>(expr), std::make_index_sequence<N>{});
+    }
+    
+    template<typename Expr>
+    StaticVector& operator=(const VectorExpression<Expr>& expr) {
+        // 先算出全部结果再写回，p = p.yzx() 一类的自引用表达式也安全
+        std::array<T, N> result;
+        evaluate(static_cast<const Expr&>(expr), result, std::make_index_sequence<N>{});
+        data_ = result;
+        return *this;
+    }
+    
+    T& operator[](size_t i) {
+        return data_[i];
+    }
+    
+    const T& operator[](size_t i) const {
+        return data_[i];
+    }
+    
+    template<size_t M>
+    ET_ALWAYS_INLINE Packet<T, M> packet(size_t i) const {
+        return Packet<T, M>::load(data_.data() + i);
+    }
+    
+    static constexpr size_t size() {
+        return N;
+    }
+    
+    T* data() {
+        return data_.data();
+    }
+    
+    const T* data() const {
+        return data_.data();
+    }
+    
+    iterator begin() {
+        return data_.data();
+    }
+    
+    iterator end() {
+        return data_.data() + N;
+    }
+    
+    const_iterator begin() const {
+        return data_.data();
+    }
+    
+    const_iterator end() const {
+        return data_.data() + N;
+    }
+    
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return detail::leafAliasing(data_.data(), N, dst);
+    }
+    
+    template<typename F>
+    void forEachStream(F& f) const {
+        f(data_.data(), static_cast<std::ptrdiff_t>(sizeof(T)));
+    }
+    
+private:
+    template<typename Expr>
+    static constexpr void requireStaticSize() {
+        static_assert(ExpressionTraits<Expr>::static_size == N,
+                      "只能由同样长度的定长表达式构造StaticVector");
+    }
+    
+    // 折叠表达式把求值展开为 N 条独立的赋值语句
+    template<typename Expr, size_t... I>
+    void assign(const Expr& expr, std::index_sequence<I...>) {
+        requireStaticSize<Expr>();
+        ((data_[I] = static_cast<T>(expr[I])), ...);
+    }
+    
+    template<typename Expr, size_t... I>
+    static void evaluate(const Expr& expr, std::array<T, N>& out, std::index_sequence<I...>) {
+        requireStaticSize<Expr>();
+        ((out[I] = static_cast<T>(expr[I])), ...);
+    }
+    
+    std::array<T, N> data_;
+};
+
+// 实现 VectorExpression::operator Vector<value_type>()
 template<typename Derived>
-VectorExpression<Derived>::operator Vector<double>() const {
+VectorExpression<Derived>::operator Vector<value_type>() const {
     const Derived& derived = static_cast<const Derived&>(*this);
-    Vector<double> result(derived.size());
-    for (size_t i = 0; i < derived.size(); ++i) {
-        result[i] = derived[i];
-    }
+    Vector<value_type> result(derived.size(), uninitialized);
+    detail::evaluateRange(result.data(), derived, 0, derived.size());
     return result;
 }
 
+namespace detail {
+
+// 从 offset 开始读取表达式：Shifted(x, offset)[i] = x[i + offset]，
+// 用来把子表达式的一段求值到缓冲区的开头（见 Stencil.hpp、SharedExpression.hpp）
+template<typename Expr>
+class Shifted {
+public:
+    Shifted(const Expr& expr, size_t offset) : expr_(expr), offset_(offset) {}
+
+    decltype(auto) operator[](size_t i) const {
+        return expr_[i + offset_];
+    }
+
+    template<size_t N>
+    ET_ALWAYS_INLINE auto packet(size_t i) const {
+        return expr_.template packet<N>(i + offset_);
+    }
+
+private:
+    const Expr& expr_;
+    size_t offset_;
+};
+
+} // namespace detail
+
+template<typename Expr>
+struct ExpressionTraits<detail::Shifted<Expr>> {
+    using value_type = expression_value_t<Expr>;
+    static constexpr bool vectorizable = ExpressionTraits<Expr>::vectorizable;
+    static constexpr size_t static_size = 0;
+};
+
 // ========================
 // 向量加法表达式
 // ========================
 template<typename LhsExpr, typename RhsExpr>
 class VectorSum : public VectorExpression<VectorSum<LhsExpr, RhsExpr>> {
 public:
+    using value_type = expression_value_t<VectorSum>;
+    
     VectorSum(const VectorExpression<LhsExpr>& lhs, 
              const VectorExpression<RhsExpr>& rhs)
         : lhs_(static_cast<const LhsExpr&>(lhs)),
           rhs_(static_cast<const RhsExpr&>(rhs)) {
         // 检查两个表达式的大小是否匹配
-        if (lhs_.size() != rhs_.size()) {
-            throw std::invalid_argument("向量大小不匹配");
-        }
+        detail::requireSameSize(lhs_, rhs_);
     }
     
     // 获取位置i的元素：左操作数[i] + 右操作数[i]
-    double operator[](size_t i) const {
-        return lhs_[i] + rhs_[i];
+    value_type operator[](size_t i) const {
+        return static_cast<value_type>(lhs_[i]) + static_cast<value_type>(rhs_[i]);
+    }
+    
+    template<size_t N>
+    ET_ALWAYS_INLINE Packet<value_type, N> packet(size_t i) const {
+        return detail::packetAs<value_type, LhsExpr, N>(lhs_, i) +
+               detail::packetAs<value_type, RhsExpr, N>(rhs_, i);
     }
     
     // 获取表达式的大小
@@ -144,9 +678,19 @@ public:
         return lhs_.size();
     }
     
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return detail::combineAlias(lhs_.aliasing(dst), rhs_.aliasing(dst));
+    }
+    
+    template<typename F>
+    void forEachStream(F& f) const {
+        detail::forEachStream(lhs_, f);
+        detail::forEachStream(rhs_, f);
+    }
+    
 private:
-    const LhsExpr& lhs_;
-    const RhsExpr& rhs_;
+    detail::operand_t<LhsExpr> lhs_;
+    detail::operand_t<RhsExpr> rhs_;
 };
 
 // 重载加法运算符
@@ -163,19 +707,25 @@ VectorSum<LhsExpr, RhsExpr> operator+(
 template<typename LhsExpr, typename RhsExpr>
 class VectorDifference : public VectorExpression<VectorDifference<LhsExpr, RhsExpr>> {
 public:
+    using value_type = expression_value_t<VectorDifference>;
+    
     VectorDifference(const VectorExpression<LhsExpr>& lhs, 
                     const VectorExpression<RhsExpr>& rhs)
         : lhs_(static_cast<const LhsExpr&>(lhs)),
           rhs_(static_cast<const RhsExpr&>(rhs)) {
         // 检查两个表达式的大小是否匹配
-        if (lhs_.size() != rhs_.size()) {
-            throw std::invalid_argument("向量大小不匹配");
-        }
+        detail::requireSameSize(lhs_, rhs_);
     }
     
     // 获取位置i的元素：左操作数[i] - 右操作数[i]
-    double operator[](size_t i) const {
-        return lhs_[i] - rhs_[i];
+    value_type operator[](size_t i) const {
+        return static_cast<value_type>(lhs_[i]) - static_cast<value_type>(rhs_[i]);
+    }
+    
+    template<size_t N>
+    ET_ALWAYS_INLINE Packet<value_type, N> packet(size_t i) const {
+        return detail::packetAs<value_type, LhsExpr, N>(lhs_, i) -
+               detail::packetAs<value_type, RhsExpr, N>(rhs_, i);
     }
     
     // 获取表达式的大小
@@ -183,9 +733,19 @@ public:
         return lhs_.size();
     }
     
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return detail::combineAlias(lhs_.aliasing(dst), rhs_.aliasing(dst));
+    }
+    
+    template<typename F>
+    void forEachStream(F& f) const {
+        detail::forEachStream(lhs_, f);
+        detail::forEachStream(rhs_, f);
+    }
+    
 private:
-    const LhsExpr& lhs_;
-    const RhsExpr& rhs_;
+    detail::operand_t<LhsExpr> lhs_;
+    detail::operand_t<RhsExpr> rhs_;
 };
 
 // 重载减法运算符
@@ -199,15 +759,23 @@ VectorDifference<LhsExpr, RhsExpr> operator-(
 // ========================
 // 向量与标量乘法表达式
 // ========================
-template<typename Expr>
-class VectorScaled : public VectorExpression<VectorScaled<Expr>> {
+template<typename Expr, typename Scalar = double>
+class VectorScaled : public VectorExpression<VectorScaled<Expr, Scalar>> {
 public:
-    VectorScaled(const VectorExpression<Expr>& expr, double scalar)
-        : expr_(static_cast<const Expr&>(expr)), scalar_(scalar) {}
+    using value_type = expression_value_t<VectorScaled>;
+    
+    VectorScaled(const VectorExpression<Expr>& expr, Scalar scalar)
+        : expr_(static_cast<const Expr&>(expr)), scalar_(static_cast<value_type>(scalar)) {}
     
     // 获取位置i的元素：表达式[i] * 标量
-    double operator[](size_t i) const {
-        return expr_[i] * scalar_;
+    value_type operator[](size_t i) const {
+        return static_cast<value_type>(expr_[i]) * scalar_;
+    }
+    
+    template<size_t N>
+    ET_ALWAYS_INLINE Packet<value_type, N> packet(size_t i) const {
+        return detail::packetAs<value_type, Expr, N>(expr_, i) *
+               Packet<value_type, N>::broadcast(scalar_);
     }
     
     // 获取表达式的大小
@@ -215,25 +783,36 @@ public:
         return expr_.size();
     }
     
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return expr_.aliasing(dst);
+    }
+    
+    template<typename F>
+    void forEachStream(F& f) const {
+        detail::forEachStream(expr_, f);
+    }
+    
 private:
-    const Expr& expr_;
-    double scalar_;
+    detail::operand_t<Expr> expr_;
+    value_type scalar_;
 };
 
 // 重载标量乘法运算符（向量 * 标量）
-template<typename Expr>
-VectorScaled<Expr> operator*(
+template<typename Expr, typename Scalar,
+         typename = std::enable_if_t<std::is_arithmetic_v<Scalar>>>
+VectorScaled<Expr, Scalar> operator*(
     const VectorExpression<Expr>& expr,
-    double scalar) {
-    return VectorScaled<Expr>(expr, scalar);
+    Scalar scalar) {
+    return VectorScaled<Expr, Scalar>(expr, scalar);
 }
 
 // 重载标量乘法运算符（标量 * 向量）
-template<typename Expr>
-VectorScaled<Expr> operator*(
-    double scalar,
+template<typename Expr, typename Scalar,
+         typename = std::enable_if_t<std::is_arithmetic_v<Scalar>>>
+VectorScaled<Expr, Scalar> operator*(
+    Scalar scalar,
     const VectorExpression<Expr>& expr) {
-    return VectorScaled<Expr>(expr, scalar);
+    return VectorScaled<Expr, Scalar>(expr, scalar);
 }
 
 // ========================
@@ -242,21 +821,43 @@ VectorScaled<Expr> operator*(
 template<typename Expr, typename Func>
 class VectorApply : public VectorExpression<VectorApply<Expr, Func>> {
 public:
+    using value_type = expression_value_t<VectorApply>;
+    
     VectorApply(const VectorExpression<Expr>& expr, Func func)
         : expr_(static_cast<const Expr&>(expr)), func_(func) {}
     
     // 获取位置i的元素：应用函数到表达式[i]
-    double operator[](size_t i) const {
+    value_type operator[](size_t i) const {
         return func_(expr_[i]);
     }
     
+    // 任意函数只能逐通道调用；简单的lambda内联后编译器仍可向量化
+    template<size_t N>
+    ET_ALWAYS_INLINE Packet<value_type, N> packet(size_t i) const {
+        auto x = expr_.template packet<N>(i);
+        Packet<value_type, N> r;
+        for (size_t k = 0; k < N; ++k) {
+            r.set(k, func_(x[k]));
+        }
+        return r;
+    }
+    
     // 获取表达式的大小
     size_t size() const {
         return expr_.size();
     }
     
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return expr_.aliasing(dst);
+    }
+    
+    template<typename F>
+    void forEachStream(F& f) const {
+        detail::forEachStream(expr_, f);
+    }
+    
 private:
-    const Expr& expr_;
+    detail::operand_t<Expr> expr_;
     Func func_;
 };
 
@@ -266,20 +867,85 @@ VectorApply<Expr, Func> apply(const VectorExpression<Expr>& expr, Func func) {
     return VectorApply<Expr, Func>(expr, func);
 }
 
-// 方便使用的常见数学函数
+// ========================
+// 逐元素一元运算
+// ========================
+// 运算本身由Op策略类提供（见 SimdMath.hpp），有packet版本的运算直接走SIMD路径，
+// 不再像 apply 那样逐通道调用标量函数
+template<typename Expr, typename Op>
+class VectorUnaryOp : public VectorExpression<VectorUnaryOp<Expr, Op>> {
+public:
+    using value_type = expression_value_t<VectorUnaryOp>;
+    using operand_type = typename ExpressionTraits<VectorUnaryOp>::operand_type;
+    
+    explicit VectorUnaryOp(const VectorExpression<Expr>& expr)
+        : expr_(static_cast<const Expr&>(expr)) {}
+    
+    value_type operator[](size_t i) const {
+        return Op::apply(static_cast<operand_type>(expr_[i]));
+    }
+    
+    template<size_t N>
+    ET_ALWAYS_INLINE Packet<value_type, N> packet(size_t i) const {
+        return Op::applyPacket(expr_.template packet<N>(i));
+    }
+    
+    size_t size() const {
+        return expr_.size();
+    }
+    
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return expr_.aliasing(dst);
+    }
+    
+    template<typename F>
+    void forEachStream(F& f) const {
+        detail::forEachStream(expr_, f);
+    }
+    
+private:
+    detail::operand_t<Expr> expr_;
+};
+
+// 常见数学函数，float/double 表达式按packet求值，精度见 SimdMath.hpp
+template<typename Expr>
+VectorUnaryOp<Expr, detail::SqrtOp> sqrt(const VectorExpression<Expr>& expr) {
+    return VectorUnaryOp<Expr, detail::SqrtOp>(expr);
+}
+
+template<typename Expr>
+VectorUnaryOp<Expr, detail::AbsOp> abs(const VectorExpression<Expr>& expr) {
+    return VectorUnaryOp<Expr, detail::AbsOp>(expr);
+}
+
 template<typename Expr>
-auto sqrt(const VectorExpression<Expr>& expr) {
-    return apply(expr, [](double x) { return std::sqrt(x); });
+VectorUnaryOp<Expr, detail::SquareOp> square(const VectorExpression<Expr>& expr) {
+    return VectorUnaryOp<Expr, detail::SquareOp>(expr);
 }
 
 template<typename Expr>
-auto abs(const VectorExpression<Expr>& expr) {
-    return apply(expr, [](double x) { return std::abs(x); });
+VectorUnaryOp<Expr, detail::ExpOp> exp(const VectorExpression<Expr>& expr) {
+    return VectorUnaryOp<Expr, detail::ExpOp>(expr);
 }
 
 template<typename Expr>
-auto square(const VectorExpression<Expr>& expr) {
-    return apply(expr, [](double x) { return x * x; });
+VectorUnaryOp<Expr, detail::LogOp> log(const VectorExpression<Expr>& expr) {
+    return VectorUnaryOp<Expr, detail::LogOp>(expr);
+}
+
+template<typename Expr>
+VectorUnaryOp<Expr, detail::SinOp> sin(const VectorExpression<Expr>& expr) {
+    return VectorUnaryOp<Expr, detail::SinOp>(expr);
+}
+
+template<typename Expr>
+VectorUnaryOp<Expr, detail::CosOp> cos(const VectorExpression<Expr>& expr) {
+    return VectorUnaryOp<Expr, detail::CosOp>(expr);
+}
+
+template<typename Expr>
+VectorUnaryOp<Expr, detail::TanhOp> tanh(const VectorExpression<Expr>& expr) {
+    return VectorUnaryOp<Expr, detail::TanhOp>(expr);
 }
 
 // ========================
@@ -307,9 +973,11 @@ private:
 // 辅助函数
 // ========================
 
-// 打印向量
-template<typename T>
-void printVector(const Vector<T>& vec, const std::string& name, size_t maxDisplay = 10) {
+// 打印向量（Vector、StaticVector或任意表达式）
+template<typename Derived>
+void printVector(const VectorExpression<Derived>& expr, const std::string& name,
+                 size_t maxDisplay = 10) {
+    const Derived& vec = static_cast<const Derived&>(expr);
     std::cout << name << " = [";
     size_t count = 0;
     for (size_t i = 0; i < vec.size() && count < maxDisplay; ++i, ++count) {
@@ -371,10 +1039,31 @@ void comparePerformance() {
         result2 = traditionalComplex(a, b, c, scalar);
     }
     
+    // 关闭SIMD，对比逐元素求值的表达式模板
+    Vector<double> result3;
+    {
+        SimdLevel saved = simdLevel();
+        setSimdLevel(SimdLevel::Scalar);
+        {
+            Timer t("表达式模板标量路径 (a + b * scalar - c)");
+            result3 = a + b * scalar - c;
+        }
+        setSimdLevel(saved);
+    }
+    
+    // 并行求值
+    Vector<double> result4;
+    {
+        Timer t("表达式模板并行计算 (a + b * scalar - c)");
+        result4.assign(a + b * scalar - c, parallel);
+    }
+    
     // 验证结果
     bool correct = true;
     for (size_t i = 0; i < Size && i < 10; ++i) {
-        if (std::abs(result1[i] - result2[i]) > 1e-10) {
+        if (std::abs(result1[i] - result2[i]) > 1e-10 ||
+            std::abs(result3[i] - result2[i]) > 1e-10 ||
+            std::abs(result4[i] - result2[i]) > 1e-10) {
             correct = false;
             break;
         }
@@ -0,0 +1,199 @@
+// FusedEvaluation.hpp
+#ifndef FUSED_EVALUATION_HPP
+#define FUSED_EVALUATION_HPP
+
+#include <algorithm>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "ExpressionTemplates.hpp"
+#include "VectorView.hpp"
+
+namespace ExpressionTemplates {
+
+// ========================
+// 多输出融合求值
+// ========================
+// x = a + b; y = a - b; 要把a和b各读两遍。
+//   evaluate(tie(x, y), tie(a + b, a - b));
+// 在同一个循环里求出两个结果：每个位置先算出所有表达式的值，再依次写回，
+// 同一位置上共享的叶子只加载一次，内存流量减半
+namespace detail {
+
+// tie 的结果：左值（向量）按引用保存，临时对象（表达式节点、视图）按值保存
+template<typename... Items>
+struct Tied {
+    std::tuple<Items...> items;
+};
+
+// 一个输出的写入位置，第i个元素位于 data[i * stride]
+template<typename T>
+struct OutputSlot {
+    T* data;
+    std::ptrdiff_t stride;
+};
+
+template<typename Target>
+struct OutputTraits;
+
+template<typename T>
+struct OutputTraits<Vector<T>> {
+    using value_type = T;
+
+    // 大小不符时直接换成新的未初始化存储，元素随后会被全部覆盖
+    static OutputSlot<T> prepare(Vector<T>& v, size_t n) {
+        if (v.size() != n) {
+            v = Vector<T>(n, uninitialized);
+        }
+        return OutputSlot<T>{v.data(), 1};
+    }
+};
+
+template<typename T, std::ptrdiff_t Stride>
+struct OutputTraits<VectorView<T, Stride>> {
+    static_assert(!std::is_const_v<T>, "只读视图不能作为赋值目标");
+    using value_type = T;
+
+    static OutputSlot<T> prepare(VectorView<T, Stride>& v, size_t n) {
+        if (v.size() != n) {
+            throw std::invalid_argument("向量大小不匹配");
+        }
+        return OutputSlot<T>{v.data(), v.stride()};
+    }
+};
+
+// 所有表达式共用的packet通道数：按最宽的值类型计算，任何一个只能走标量路径时为0
+template<size_t Bytes, typename... Exprs>
+constexpr size_t commonPacketLanes() {
+    if constexpr (Bytes != 0 && ((packetLanes<Bytes, Exprs>() != 0) && ...)) {
+        return Bytes / std::max({sizeof(expression_value_t<Exprs>)...});
+    } else {
+        return 0;
+    }
+}
+
+// 多输出赋值内核：每个位置（或每个packet）先求出全部表达式，再统一写回，
+// 因此 evaluate(tie(a, b), tie(a + b, a - b)) 这种输出也是输入的写法同样正确
+struct MultiAssignKernel {
+    template<size_t Bytes, typename... Ts, typename... Exprs>
+    static ET_ALWAYS_INLINE void run(const std::tuple<OutputSlot<Ts>...>& slots,
+                                     const std::tuple<Exprs...>& exprs,
+                                     size_t begin, size_t end, bool contiguous) {
+        run<Bytes>(slots, exprs, begin, end, contiguous, std::index_sequence_for<Exprs...>{});
+    }
+
+    template<size_t Bytes, typename... Ts, typename... Exprs, size_t... I>
+    static ET_ALWAYS_INLINE void run(const std::tuple<OutputSlot<Ts>...>& slots,
+                                     const std::tuple<Exprs...>& exprs,
+                                     size_t begin, size_t end, bool contiguous,
+                                     std::index_sequence<I...>) {
+        size_t i = begin;
+        constexpr size_t N = commonPacketLanes<Bytes, std::decay_t<Exprs>...>();
+        if constexpr (N != 0 && (is_packet_type<Ts> && ...)) {
+            if (contiguous) {
+                for (; i + N <= end; i += N) {
+                    auto packets = std::make_tuple(
+                        std::get<I>(exprs).template packet<N>(i).template cast<Ts>()...);
+                    (std::get<I>(packets).store(std::get<I>(slots).data + i), ...);
+                }
+            }
+        }
+        for (; i < end; ++i) {
+            auto values = std::make_tuple(static_cast<Ts>(std::get<I>(exprs)[i])...);
+            ((std::get<I>(slots).data[static_cast<std::ptrdiff_t>(i) * std::get<I>(slots).stride] =
+                  std::get<I>(values)), ...);
+        }
+    }
+};
+
+// 任意一个表达式与任意一个输出错位重叠，或者会被重新分配的输出出现在输入里，
+// 就改为先把每个表达式求值到临时向量
+template<typename Targets, typename Exprs, size_t... I>
+bool fusedNeedsTemporary(Targets& targets, const Exprs& exprs, size_t n,
+                         std::index_sequence<I...>) {
+    bool unsafe = false;
+    auto checkTarget = [&](auto& target) {
+        MemoryRegion region = target.region();
+        auto checkExpr = [&](const auto& expr) {
+            AliasKind kind = expr.aliasing(region);
+            unsafe |= kind == AliasKind::Overlap ||
+                      (kind != AliasKind::None && target.size() != n);
+        };
+        (checkExpr(std::get<I>(exprs)), ...);
+    };
+    (checkTarget(std::get<I>(targets)), ...);
+    return unsafe;
+}
+
+template<typename... Targets, typename... Exprs, size_t... I>
+void evaluateFused(std::tuple<Targets...>& targets, const std::tuple<Exprs...>& exprs,
+                   bool parallelize, std::index_sequence<I...> indices) {
+    const size_t n = std::get<0>(exprs).size();
+    if (((std::get<I>(exprs).size() != n) || ...)) {
+        throw std::invalid_argument("向量大小不匹配");
+    }
+
+    if (fusedNeedsTemporary(targets, exprs, n, indices)) {
+        auto temps = std::make_tuple(
+            Vector<expression_value_t<std::decay_t<Exprs>>>(std::get<I>(exprs))...);
+        ((std::get<I>(targets) = std::move(std::get<I>(temps))), ...);
+        return;
+    }
+
+    auto slots = std::make_tuple(
+        OutputTraits<std::decay_t<Targets>>::prepare(std::get<I>(targets), n)...);
+    const bool contiguous = ((std::get<I>(slots).stride == 1) && ...);
+
+    ThreadPool& pool = ThreadPool::instance();
+    if (!parallelize || n < parallelThreshold() || pool.workerCount() == 0) {
+        simdDispatch<MultiAssignKernel>(slots, exprs, size_t{0}, n, contiguous);
+        return;
+    }
+    using First = std::decay_t<std::tuple_element_t<0, std::tuple<Targets...>>>;
+    const size_t chunk = parallelChunkSize<typename OutputTraits<First>::value_type>();
+    const size_t chunks = (n + chunk - 1) / chunk;
+    pool.run(chunks, [&](size_t c) {
+        size_t begin = c * chunk;
+        simdDispatch<MultiAssignKernel>(slots, exprs, begin, std::min(n, begin + chunk),
+                                        contiguous);
+    });
+}
+
+template<typename Item>
+constexpr bool isVectorExpression =
+    std::is_base_of_v<VectorExpression<std::decay_t<Item>>, std::decay_t<Item>>;
+
+} // namespace detail
+
+// 把若干输出或若干表达式打包，供 evaluate 使用
+template<typename... Items>
+detail::Tied<Items...> tie(Items&&... items) {
+    return detail::Tied<Items...>{std::tuple<Items...>(std::forward<Items>(items)...)};
+}
+
+// outputs 中的第k个得到 exprs 中第k个表达式的值，所有表达式在同一个循环里求值
+template<typename... Targets, typename... Exprs>
+void evaluate(detail::Tied<Targets...> outputs, const detail::Tied<Exprs...>& exprs) {
+    static_assert(sizeof...(Targets) == sizeof...(Exprs), "输出与表达式的个数必须相同");
+    static_assert(sizeof...(Exprs) > 0, "至少需要一个表达式");
+    static_assert((detail::isVectorExpression<Exprs> && ...), "tie中的每一项都必须是向量表达式");
+    detail::evaluateFused(outputs.items, exprs.items, false,
+                          std::index_sequence_for<Exprs...>{});
+}
+
+// 并行版本：按块分给线程池，每个块内仍然融合求值
+template<typename... Targets, typename... Exprs>
+void evaluate(detail::Tied<Targets...> outputs, const detail::Tied<Exprs...>& exprs,
+              ParallelTag) {
+    static_assert(sizeof...(Targets) == sizeof...(Exprs), "输出与表达式的个数必须相同");
+    static_assert(sizeof...(Exprs) > 0, "至少需要一个表达式");
+    static_assert((detail::isVectorExpression<Exprs> && ...), "tie中的每一项都必须是向量表达式");
+    detail::evaluateFused(outputs.items, exprs.items, true,
+                          std::index_sequence_for<Exprs...>{});
+}
+
+} // namespace ExpressionTemplates
+
+#endif // FUSED_EVALUATION_HPP
@@ -0,0 +1,252 @@
+// MappedVector.hpp
+#ifndef MAPPED_VECTOR_HPP
+#define MAPPED_VECTOR_HPP
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ExpressionTemplates.hpp"
+
+namespace ExpressionTemplates {
+
+// 映射方式
+enum class MapMode {
+    ReadOnly,     // 只读，多个进程可共享同一份页缓存
+    CopyOnWrite   // 可写，修改只影响本进程（写入时才复制对应的页），不会写回文件
+};
+
+// ========================
+// 内存映射向量：把 Vector::save() 写出的二进制文件直接映射为向量
+// ========================
+// 构造时只建立映射，不读取文件内容，元素在第一次访问时才按页从文件载入。
+// 几个GB的系数向量因此不必在启动时整体读入并解析：
+//   MappedVector<double> coeffs("coeffs.bin");
+//   Vector<double> y = coeffs * 2.0 + x;
+// 文件格式就是元素的原始字节（本机字节序，没有文件头）
+// 条款13: 以对象管理资源 —— 析构时解除映射
+// 条款14: 在资源管理类中小心copying行为 —— 禁止复制，允许移动
+template<typename T>
+class MappedVector;
+
+template<typename T>
+struct ExpressionTraits<MappedVector<T>> {
+    using value_type = T;
+    static constexpr bool vectorizable = detail::is_packet_type<T>;
+    static constexpr size_t static_size = 0;
+};
+
+namespace detail {
+
+template<typename T>
+struct OperandStorage<MappedVector<T>> {
+    using type = const MappedVector<T>&;
+};
+
+} // namespace detail
+
+template<typename T>
+class MappedVector : public VectorExpression<MappedVector<T>> {
+public:
+    static_assert(std::is_trivially_copyable_v<T>, "只能映射可以按字节复制的元素类型");
+
+    using value_type = T;
+    using const_iterator = const T*;
+
+    MappedVector() = default;
+
+    explicit MappedVector(const std::string& path, MapMode mode = MapMode::ReadOnly)
+        : mode_(mode) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error("无法打开文件: " + path + ": " + std::strerror(errno));
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            int error = errno;
+            ::close(fd);
+            throw std::runtime_error("无法读取文件信息: " + path + ": " + std::strerror(error));
+        }
+        const size_t bytes = static_cast<size_t>(info.st_size);
+        if (bytes % sizeof(T) != 0) {
+            ::close(fd);
+            throw std::runtime_error("文件大小不是元素大小的整数倍: " + path);
+        }
+        size_ = bytes / sizeof(T);
+        // 空文件不能映射，保持空向量
+        if (size_ != 0) {
+            int protection = mode == MapMode::ReadOnly ? PROT_READ : PROT_READ | PROT_WRITE;
+            void* address = ::mmap(nullptr, bytes, protection, MAP_PRIVATE, fd, 0);
+            if (address == MAP_FAILED) {
+                int error = errno;
+                ::close(fd);
+                throw std::runtime_error("无法映射文件: " + path + ": " + std::strerror(error));
+            }
+            data_ = static_cast<T*>(address);
+            // 表达式按顺序遍历，让内核加大预读窗口
+            ::madvise(address, bytes, MADV_SEQUENTIAL);
+        }
+        // 映射建立后即可关闭文件描述符，映射本身保持有效
+        ::close(fd);
+    }
+
+    MappedVector(const MappedVector&) = delete;
+    MappedVector& operator=(const MappedVector&) = delete;
+
+    MappedVector(MappedVector&& other) noexcept {
+        swap(other);
+    }
+
+    MappedVector& operator=(MappedVector&& other) noexcept {
+        MappedVector(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    ~MappedVector() {
+        if (data_ != nullptr) {
+            ::munmap(data_, size_ * sizeof(T));
+        }
+    }
+
+    // 写时复制的映射可以作为赋值目标，大小必须相同（映射不能改变长度）。
+    // 先检查能否赋值，再求值到临时向量，避免白白计算整个表达式后才抛出异常
+    template<typename Expr>
+    MappedVector& operator=(const VectorExpression<Expr>& expr) {
+        requireAssignable(expr);
+        if (expr.aliasing(region()) == detail::AliasKind::Overlap) {
+            Vector<T> temp(expr);
+            return evaluateInto(temp);
+        }
+        return evaluateInto(expr);
+    }
+
+    // 并行赋值：按块分给线程池
+    template<typename Expr>
+    MappedVector& assign(const VectorExpression<Expr>& expr, ParallelTag) {
+        requireAssignable(expr);
+        if (expr.aliasing(region()) == detail::AliasKind::Overlap) {
+            Vector<T> temp(expr);
+            return evaluateInto(temp, parallel);
+        }
+        return evaluateInto(expr, parallel);
+    }
+
+    // 调用者保证表达式不与本向量错位重叠，跳过别名检查
+    detail::NoAlias<MappedVector> noalias() {
+        return detail::NoAlias<MappedVector>(*this);
+    }
+
+    const T& operator[](size_t i) const {
+        return data_[i];
+    }
+
+    template<size_t N>
+    ET_ALWAYS_INLINE Packet<T, N> packet(size_t i) const {
+        return Packet<T, N>::load(data_ + i);
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    MapMode mode() const {
+        return mode_;
+    }
+
+    const T* data() const {
+        return data_;
+    }
+
+    // 只有写时复制的映射可以修改元素
+    T* mutableData() {
+        requireWritable();
+        return data_;
+    }
+
+    const_iterator begin() const {
+        return data_;
+    }
+
+    const_iterator end() const {
+        return data_ + size_;
+    }
+
+    detail::MemoryRegion region() const {
+        return detail::regionOf(data_, size_);
+    }
+
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return detail::leafAliasing(data_, size_, dst);
+    }
+
+    template<typename F>
+    void forEachStream(F& f) const {
+        f(data_, static_cast<std::ptrdiff_t>(sizeof(T)));
+    }
+
+    // 条款25: 考虑写出一个不抛异常的swap函数
+    void swap(MappedVector& other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(mode_, other.mode_);
+    }
+
+private:
+    friend class detail::NoAlias<MappedVector>;
+
+    void requireWritable() const {
+        if (mode_ != MapMode::CopyOnWrite) {
+            throw std::logic_error("只读映射不能修改");
+        }
+    }
+
+    template<typename Expr>
+    void requireAssignable(const VectorExpression<Expr>& expr) const {
+        requireWritable();
+        if (expr.size() != size_) {
+            throw std::invalid_argument("向量大小不匹配");
+        }
+    }
+
+    // noalias() 的入口：跳过别名检查，但只读映射和大小不符仍要拒绝
+    template<typename Expr>
+    MappedVector& assignDirect(const VectorExpression<Expr>& expr) {
+        requireAssignable(expr);
+        return evaluateInto(expr);
+    }
+
+    template<typename Expr>
+    MappedVector& assignDirect(const VectorExpression<Expr>& expr, ParallelTag) {
+        requireAssignable(expr);
+        return evaluateInto(expr, parallel);
+    }
+
+    // 调用者已经做过 requireAssignable
+    template<typename Expr>
+    MappedVector& evaluateInto(const VectorExpression<Expr>& expr) {
+        detail::evaluateRange(data_, static_cast<const Expr&>(expr), 0, size_);
+        return *this;
+    }
+
+    template<typename Expr>
+    MappedVector& evaluateInto(const VectorExpression<Expr>& expr, ParallelTag) {
+        detail::evaluateParallel(data_, static_cast<const Expr&>(expr), size_);
+        return *this;
+    }
+
+    T* data_ = nullptr;
+    size_t size_ = 0;
+    MapMode mode_ = MapMode::ReadOnly;
+};
+
+} // namespace ExpressionTemplates
+
+#endif // MAPPED_VECTOR_HPP
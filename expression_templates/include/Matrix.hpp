@@ -0,0 +1,729 @@
+// Matrix.hpp
+#ifndef MATRIX_HPP
+#define MATRIX_HPP
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ExpressionTemplates.hpp"
+
+namespace ExpressionTemplates {
+
+// 矩阵沿用向量的CRTP表达式机制：逐元素运算与转置是惰性的视图，
+// 乘积则由分块内核立即求值（见下文）
+
+// 前置声明
+template<typename T>
+class Matrix;
+
+template<typename LhsExpr, typename RhsExpr>
+class MatrixSum;
+
+template<typename LhsExpr, typename RhsExpr>
+class MatrixDifference;
+
+template<typename Expr, typename Scalar>
+class MatrixScaled;
+
+template<typename Expr>
+class MatrixTranspose;
+
+template<typename T>
+struct ExpressionTraits<Matrix<T>> : ExpressionTraits<Vector<T>> {};
+
+template<typename LhsExpr, typename RhsExpr>
+struct ExpressionTraits<MatrixSum<LhsExpr, RhsExpr>>
+    : ExpressionTraits<VectorSum<LhsExpr, RhsExpr>> {};
+
+template<typename LhsExpr, typename RhsExpr>
+struct ExpressionTraits<MatrixDifference<LhsExpr, RhsExpr>>
+    : ExpressionTraits<VectorSum<LhsExpr, RhsExpr>> {};
+
+template<typename Expr, typename Scalar>
+struct ExpressionTraits<MatrixScaled<Expr, Scalar>>
+    : ExpressionTraits<VectorScaled<Expr, Scalar>> {};
+
+template<typename Expr>
+struct ExpressionTraits<MatrixTranspose<Expr>> : ExpressionTraits<Expr> {};
+
+namespace detail {
+
+template<typename T>
+struct OperandStorage<Matrix<T>> {
+    using type = const Matrix<T>&;
+};
+
+} // namespace detail
+
+// ========================
+// 矩阵表达式基类
+// ========================
+template<typename Derived>
+class MatrixExpression {
+public:
+    using value_type = expression_value_t<Derived>;
+
+    // 获取第r行第c列的元素
+    value_type operator()(size_t r, size_t c) const {
+        return static_cast<const Derived&>(*this)(r, c);
+    }
+
+    // 一次取出第r行从c开始的N个元素
+    template<size_t N>
+    ET_ALWAYS_INLINE Packet<value_type, N> packet(size_t r, size_t c) const {
+        return static_cast<const Derived&>(*this).template packet<N>(r, c);
+    }
+
+    size_t rows() const {
+        return static_cast<const Derived&>(*this).rows();
+    }
+
+    size_t cols() const {
+        return static_cast<const Derived&>(*this).cols();
+    }
+
+    // 表达式读取的内存与赋值目标的重叠关系
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return static_cast<const Derived&>(*this).aliasing(dst);
+    }
+};
+
+namespace detail {
+
+// 把矩阵表达式的一行包装成向量表达式，逐行复用向量的SIMD赋值内核
+template<typename Expr>
+class MatrixRow;
+
+} // namespace detail
+
+template<typename Expr>
+struct ExpressionTraits<detail::MatrixRow<Expr>> : ExpressionTraits<Expr> {};
+
+namespace detail {
+
+template<typename Expr>
+class MatrixRow : public VectorExpression<MatrixRow<Expr>> {
+public:
+    using value_type = expression_value_t<Expr>;
+
+    MatrixRow(const Expr& expr, size_t row) : expr_(expr), row_(row) {}
+
+    value_type operator[](size_t c) const {
+        return expr_(row_, c);
+    }
+
+    template<size_t N>
+    ET_ALWAYS_INLINE Packet<value_type, N> packet(size_t c) const {
+        return expr_.template packet<N>(row_, c);
+    }
+
+    size_t size() const {
+        return expr_.cols();
+    }
+
+    // 保守地按整个矩阵表达式判断
+    AliasKind aliasing(const MemoryRegion& dst) const {
+        return expr_.aliasing(dst);
+    }
+
+private:
+    const Expr& expr_;
+    size_t row_;
+};
+
+template<typename LhsExpr, typename RhsExpr>
+void requireSameShape(const LhsExpr& lhs, const RhsExpr& rhs) {
+    if (lhs.rows() != rhs.rows() || lhs.cols() != rhs.cols()) {
+        throw std::invalid_argument("矩阵大小不匹配");
+    }
+}
+
+} // namespace detail
+
+// ========================
+// 矩阵类，按行主序存储
+// ========================
+template<typename T>
+class Matrix : public MatrixExpression<Matrix<T>> {
+public:
+    using value_type = T;
+
+    Matrix() = default;
+
+    Matrix(size_t rows, size_t cols) : rows_(rows), cols_(cols), data_(rows * cols) {}
+
+    Matrix(size_t rows, size_t cols, T value)
+        : rows_(rows), cols_(cols), data_(rows * cols, value) {}
+
+    // 从表达式构造矩阵
+    template<typename Expr>
+    Matrix(const MatrixExpression<Expr>& expr)
+        : rows_(expr.rows()), cols_(expr.cols()), data_(rows_ * cols_, uninitialized) {
+        evaluate(static_cast<const Expr&>(expr));
+    }
+
+    // 从表达式赋值
+    // 转置视图与目标是同一个矩阵时（m = transpose(m)）直接写回会读到已被覆盖的元素，
+    // 别名分析发现这种情况后先求值到临时矩阵再交换
+    template<typename Expr>
+    Matrix& operator=(const MatrixExpression<Expr>& expr) {
+        if (needsTemporary(expr)) {
+            Matrix temp(expr);
+            swap(temp);
+            return *this;
+        }
+        return assignDirect(expr);
+    }
+
+    // 调用者保证表达式不与本矩阵错位重叠，跳过别名检查
+    detail::NoAlias<Matrix> noalias() {
+        return detail::NoAlias<Matrix>(*this);
+    }
+
+    // 条款25: 考虑写出一个不抛异常的swap函数
+    void swap(Matrix& other) noexcept {
+        std::swap(rows_, other.rows_);
+        std::swap(cols_, other.cols_);
+        data_.swap(other.data_);
+    }
+
+    T& operator()(size_t r, size_t c) {
+        return data_[r * cols_ + c];
+    }
+
+    const T& operator()(size_t r, size_t c) const {
+        return data_[r * cols_ + c];
+    }
+
+    template<size_t N>
+    ET_ALWAYS_INLINE Packet<T, N> packet(size_t r, size_t c) const {
+        return Packet<T, N>::load(data_.data() + r * cols_ + c);
+    }
+
+    size_t rows() const {
+        return rows_;
+    }
+
+    size_t cols() const {
+        return cols_;
+    }
+
+    // 条款15: 在资源管理类中提供对原始资源的访问
+    T* data() {
+        return data_.data();
+    }
+
+    const T* data() const {
+        return data_.data();
+    }
+
+    detail::MemoryRegion region() const {
+        return detail::regionOf(data_.data(), data_.size());
+    }
+
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return detail::leafAliasing(data_.data(), data_.size(), dst);
+    }
+
+private:
+    friend class detail::NoAlias<Matrix>;
+
+    // 形状改变时目标的下标映射也会改变，任何重叠都需要临时矩阵
+    template<typename Expr>
+    bool needsTemporary(const MatrixExpression<Expr>& expr) const {
+        detail::AliasKind kind = expr.aliasing(region());
+        return kind == detail::AliasKind::Overlap ||
+               (kind != detail::AliasKind::None &&
+                (expr.rows() != rows_ || expr.cols() != cols_));
+    }
+
+    template<typename Expr>
+    Matrix& assignDirect(const MatrixExpression<Expr>& expr) {
+        rows_ = expr.rows();
+        cols_ = expr.cols();
+        data_.resizeForOverwrite(rows_ * cols_);
+        evaluate(static_cast<const Expr&>(expr));
+        return *this;
+    }
+
+    template<typename Expr>
+    void evaluate(const Expr& expr) {
+        for (size_t r = 0; r < rows_; ++r) {
+            detail::MatrixRow<Expr> row(expr, r);
+            detail::evaluateRange(data_.data() + r * cols_, row, 0, cols_);
+        }
+    }
+
+    size_t rows_ = 0;
+    size_t cols_ = 0;
+    AlignedBuffer<T> data_;
+};
+
+// ========================
+// 逐元素矩阵运算
+// ========================
+template<typename LhsExpr, typename RhsExpr>
+class MatrixSum : public MatrixExpression<MatrixSum<LhsExpr, RhsExpr>> {
+public:
+    using value_type = expression_value_t<MatrixSum>;
+
+    MatrixSum(const MatrixExpression<LhsExpr>& lhs, const MatrixExpression<RhsExpr>& rhs)
+        : lhs_(static_cast<const LhsExpr&>(lhs)), rhs_(static_cast<const RhsExpr&>(rhs)) {
+        detail::requireSameShape(lhs_, rhs_);
+    }
+
+    value_type operator()(size_t r, size_t c) const {
+        return static_cast<value_type>(lhs_(r, c)) + static_cast<value_type>(rhs_(r, c));
+    }
+
+    template<size_t N>
+    ET_ALWAYS_INLINE Packet<value_type, N> packet(size_t r, size_t c) const {
+        return lhs_.template packet<N>(r, c).template cast<value_type>() +
+               rhs_.template packet<N>(r, c).template cast<value_type>();
+    }
+
+    size_t rows() const {
+        return lhs_.rows();
+    }
+
+    size_t cols() const {
+        return lhs_.cols();
+    }
+
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return detail::combineAlias(lhs_.aliasing(dst), rhs_.aliasing(dst));
+    }
+
+private:
+    detail::operand_t<LhsExpr> lhs_;
+    detail::operand_t<RhsExpr> rhs_;
+};
+
+template<typename LhsExpr, typename RhsExpr>
+MatrixSum<LhsExpr, RhsExpr> operator+(const MatrixExpression<LhsExpr>& lhs,
+                                      const MatrixExpression<RhsExpr>& rhs) {
+    return MatrixSum<LhsExpr, RhsExpr>(lhs, rhs);
+}
+
+template<typename LhsExpr, typename RhsExpr>
+class MatrixDifference : public MatrixExpression<MatrixDifference<LhsExpr, RhsExpr>> {
+public:
+    using value_type = expression_value_t<MatrixDifference>;
+
+    MatrixDifference(const MatrixExpression<LhsExpr>& lhs, const MatrixExpression<RhsExpr>& rhs)
+        : lhs_(static_cast<const LhsExpr&>(lhs)), rhs_(static_cast<const RhsExpr&>(rhs)) {
+        detail::requireSameShape(lhs_, rhs_);
+    }
+
+    value_type operator()(size_t r, size_t c) const {
+        return static_cast<value_type>(lhs_(r, c)) - static_cast<value_type>(rhs_(r, c));
+    }
+
+    template<size_t N>
+    ET_ALWAYS_INLINE Packet<value_type, N> packet(size_t r, size_t c) const {
+        return lhs_.template packet<N>(r, c).template cast<value_type>() -
+               rhs_.template packet<N>(r, c).template cast<value_type>();
+    }
+
+    size_t rows() const {
+        return lhs_.rows();
+    }
+
+    size_t cols() const {
+        return lhs_.cols();
+    }
+
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return detail::combineAlias(lhs_.aliasing(dst), rhs_.aliasing(dst));
+    }
+
+private:
+    detail::operand_t<LhsExpr> lhs_;
+    detail::operand_t<RhsExpr> rhs_;
+};
+
+template<typename LhsExpr, typename RhsExpr>
+MatrixDifference<LhsExpr, RhsExpr> operator-(const MatrixExpression<LhsExpr>& lhs,
+                                             const MatrixExpression<RhsExpr>& rhs) {
+    return MatrixDifference<LhsExpr, RhsExpr>(lhs, rhs);
+}
+
+template<typename Expr, typename Scalar = double>
+class MatrixScaled : public MatrixExpression<MatrixScaled<Expr, Scalar>> {
+public:
+    using value_type = expression_value_t<MatrixScaled>;
+
+    MatrixScaled(const MatrixExpression<Expr>& expr, Scalar scalar)
+        : expr_(static_cast<const Expr&>(expr)), scalar_(static_cast<value_type>(scalar)) {}
+
+    value_type operator()(size_t r, size_t c) const {
+        return static_cast<value_type>(expr_(r, c)) * scalar_;
+    }
+
+    template<size_t N>
+    ET_ALWAYS_INLINE Packet<value_type, N> packet(size_t r, size_t c) const {
+        return expr_.template packet<N>(r, c).template cast<value_type>() *
+               Packet<value_type, N>::broadcast(scalar_);
+    }
+
+    size_t rows() const {
+        return expr_.rows();
+    }
+
+    size_t cols() const {
+        return expr_.cols();
+    }
+
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return expr_.aliasing(dst);
+    }
+
+private:
+    detail::operand_t<Expr> expr_;
+    value_type scalar_;
+};
+
+template<typename Expr, typename Scalar,
+         typename = std::enable_if_t<std::is_arithmetic_v<Scalar>>>
+MatrixScaled<Expr, Scalar> operator*(const MatrixExpression<Expr>& expr, Scalar scalar) {
+    return MatrixScaled<Expr, Scalar>(expr, scalar);
+}
+
+template<typename Expr, typename Scalar,
+         typename = std::enable_if_t<std::is_arithmetic_v<Scalar>>>
+MatrixScaled<Expr, Scalar> operator*(Scalar scalar, const MatrixExpression<Expr>& expr) {
+    return MatrixScaled<Expr, Scalar>(expr, scalar);
+}
+
+// ========================
+// 转置视图，不复制数据
+// ========================
+template<typename Expr>
+class MatrixTranspose : public MatrixExpression<MatrixTranspose<Expr>> {
+public:
+    using value_type = expression_value_t<MatrixTranspose>;
+
+    explicit MatrixTranspose(const MatrixExpression<Expr>& expr)
+        : expr_(static_cast<const Expr&>(expr)) {}
+
+    value_type operator()(size_t r, size_t c) const {
+        return expr_(c, r);
+    }
+
+    // 转置后的一行是原矩阵的一列，只能逐通道收集
+    template<size_t N>
+    ET_ALWAYS_INLINE Packet<value_type, N> packet(size_t r, size_t c) const {
+        Packet<value_type, N> p;
+        for (size_t k = 0; k < N; ++k) {
+            p.set(k, expr_(c + k, r));
+        }
+        return p;
+    }
+
+    size_t rows() const {
+        return expr_.cols();
+    }
+
+    size_t cols() const {
+        return expr_.rows();
+    }
+
+    // 转置后(r, c)读取的是(c, r)，只要与目标有重叠就是错位重叠
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return expr_.aliasing(dst) == detail::AliasKind::None ? detail::AliasKind::None
+                                                               : detail::AliasKind::Overlap;
+    }
+
+private:
+    detail::operand_t<Expr> expr_;
+};
+
+template<typename Expr>
+MatrixTranspose<Expr> transpose(const MatrixExpression<Expr>& expr) {
+    return MatrixTranspose<Expr>(expr);
+}
+
+// ========================
+// 矩阵乘积
+// ========================
+// 乘积的每个元素需要O(k)次运算，惰性地逐元素求值会重复读取整行整列，
+// 因此乘积立即由分块内核求值并按值返回结果
+// 条款21: 必须返回对象时，别妄想返回其reference
+namespace detail {
+
+// 分块GEMM（BLIS的做法）：
+//   NC列 × KC行的B面板打包成连续内存，放在L3/L2；
+//   MC行 × KC列的A块打包成连续内存，放在L2；
+//   微内核在寄存器里累加 MR × NR 的C块，每次k迭代复用一次B的两个packet和A的MR个标量
+struct GemmKernel {
+    static constexpr size_t MR = 4;
+    static constexpr size_t KC = 256;
+    static constexpr size_t MC = 128;
+    static constexpr size_t NC = 2048;
+
+    template<size_t Bytes, typename T, typename LhsExpr, typename RhsExpr>
+    static ET_ALWAYS_INLINE void run(T* c, const LhsExpr& a, const RhsExpr& b) {
+        // 标量路径使用单通道packet，保持同一套代码
+        constexpr size_t N = Bytes == 0 ? 1 : Bytes / sizeof(T);
+        constexpr size_t NR = 2 * N;
+        using P = Packet<T, N>;
+
+        const size_t m = a.rows();
+        const size_t n = b.cols();
+        const size_t depth = a.cols();
+
+        // 打包缓冲区按实际尺寸分配，小矩阵不必为整块付出清零的代价
+        const size_t kcMax = std::min(KC, depth);
+        std::vector<T> packedA(kcMax * ((std::min(MC, m) + MR - 1) / MR * MR));
+        std::vector<T> packedB(kcMax * ((std::min(NC, n) + NR - 1) / NR * NR));
+
+        for (size_t jc = 0; jc < n; jc += NC) {
+            const size_t nc = std::min(NC, n - jc);
+            for (size_t pc = 0; pc < depth; pc += KC) {
+                const size_t kc = std::min(KC, depth - pc);
+
+                // 打包B：每NR列一组，组内按k连续，不足NR的列补零
+                for (size_t jr = 0; jr < nc; jr += NR) {
+                    T* dst = packedB.data() + jr * kc;
+                    for (size_t p = 0; p < kc; ++p) {
+                        for (size_t j = 0; j < NR; ++j) {
+                            dst[p * NR + j] = jr + j < nc ? static_cast<T>(b(pc + p, jc + jr + j)) : T(0);
+                        }
+                    }
+                }
+
+                for (size_t ic = 0; ic < m; ic += MC) {
+                    const size_t mc = std::min(MC, m - ic);
+
+                    // 打包A：每MR行一组，组内按k连续，不足MR的行补零
+                    for (size_t ir = 0; ir < mc; ir += MR) {
+                        T* dst = packedA.data() + ir * kc;
+                        for (size_t p = 0; p < kc; ++p) {
+                            for (size_t i = 0; i < MR; ++i) {
+                                dst[p * MR + i] = ir + i < mc ? static_cast<T>(a(ic + ir + i, pc + p)) : T(0);
+                            }
+                        }
+                    }
+
+                    for (size_t jr = 0; jr < nc; jr += NR) {
+                        for (size_t ir = 0; ir < mc; ir += MR) {
+                            const T* ap = packedA.data() + ir * kc;
+                            const T* bp = packedB.data() + jr * kc;
+
+                            // 微内核：MR × NR 的C块全部留在寄存器里
+                            P acc[MR][2];
+                            for (size_t i = 0; i < MR; ++i) {
+                                acc[i][0] = P::broadcast(T(0));
+                                acc[i][1] = P::broadcast(T(0));
+                            }
+                            for (size_t p = 0; p < kc; ++p) {
+                                P b0 = P::load(bp + p * NR);
+                                P b1 = P::load(bp + p * NR + N);
+                                for (size_t i = 0; i < MR; ++i) {
+                                    P ai = P::broadcast(ap[p * MR + i]);
+                                    acc[i][0] = acc[i][0] + ai * b0;
+                                    acc[i][1] = acc[i][1] + ai * b1;
+                                }
+                            }
+
+                            // 写回C，边缘块只写有效部分
+                            const size_t rowsLeft = std::min(MR, mc - ir);
+                            const size_t colsLeft = std::min(NR, nc - jr);
+                            for (size_t i = 0; i < rowsLeft; ++i) {
+                                T* crow = c + (ic + ir + i) * n + jc + jr;
+                                if (colsLeft == NR) {
+                                    (P::load(crow) + acc[i][0]).store(crow);
+                                    (P::load(crow + N) + acc[i][1]).store(crow + N);
+                                } else {
+                                    T tile[NR];
+                                    acc[i][0].store(tile);
+                                    acc[i][1].store(tile + N);
+                                    for (size_t j = 0; j < colsLeft; ++j) {
+                                        crow[j] += tile[j];
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+};
+
+// 矩阵-向量乘积：每次同时处理4行，x的每个packet只加载一次就被4行复用
+struct GemvKernel {
+    template<size_t Bytes, typename T, typename MatExpr>
+    static ET_ALWAYS_INLINE void run(T* y, const MatExpr& a, const T* x) {
+        constexpr size_t N = packetLanes<Bytes, MatExpr>();
+        const size_t m = a.rows();
+        const size_t n = a.cols();
+
+        size_t r = 0;
+        for (; r + 4 <= m; r += 4) {
+            T s0 = T(0), s1 = T(0), s2 = T(0), s3 = T(0);
+            size_t c = 0;
+            if constexpr (N != 0 && std::is_same_v<expression_value_t<MatExpr>, T>) {
+                using P = Packet<T, N>;
+                P p0 = P::broadcast(T(0)), p1 = p0, p2 = p0, p3 = p0;
+                for (; c + N <= n; c += N) {
+                    P xp = P::load(x + c);
+                    p0 = p0 + a.template packet<N>(r, c) * xp;
+                    p1 = p1 + a.template packet<N>(r + 1, c) * xp;
+                    p2 = p2 + a.template packet<N>(r + 2, c) * xp;
+                    p3 = p3 + a.template packet<N>(r + 3, c) * xp;
+                }
+                for (size_t k = 0; k < N; ++k) {
+                    s0 += p0[k];
+                    s1 += p1[k];
+                    s2 += p2[k];
+                    s3 += p3[k];
+                }
+            }
+            for (; c < n; ++c) {
+                s0 += static_cast<T>(a(r, c)) * x[c];
+                s1 += static_cast<T>(a(r + 1, c)) * x[c];
+                s2 += static_cast<T>(a(r + 2, c)) * x[c];
+                s3 += static_cast<T>(a(r + 3, c)) * x[c];
+            }
+            y[r] = s0;
+            y[r + 1] = s1;
+            y[r + 2] = s2;
+            y[r + 3] = s3;
+        }
+        for (; r < m; ++r) {
+            T s = T(0);
+            for (size_t c = 0; c < n; ++c) {
+                s += static_cast<T>(a(r, c)) * x[c];
+            }
+            y[r] = s;
+        }
+    }
+};
+
+} // namespace detail
+
+// 矩阵 × 矩阵
+template<typename LhsExpr, typename RhsExpr>
+Matrix<detail::common_value_t<LhsExpr, RhsExpr>> operator*(const MatrixExpression<LhsExpr>& lhs,
+                                                           const MatrixExpression<RhsExpr>& rhs) {
+    using T = detail::common_value_t<LhsExpr, RhsExpr>;
+    if (lhs.cols() != rhs.rows()) {
+        throw std::invalid_argument("矩阵乘法维度不匹配");
+    }
+    Matrix<T> result(lhs.rows(), rhs.cols(), T(0));
+    if constexpr (detail::is_packet_type<T> && ET_HAS_VECTOR_EXTENSIONS) {
+        detail::simdDispatch<detail::GemmKernel>(result.data(), static_cast<const LhsExpr&>(lhs),
+                                                 static_cast<const RhsExpr&>(rhs));
+    } else {
+        for (size_t i = 0; i < lhs.rows(); ++i) {
+            for (size_t k = 0; k < lhs.cols(); ++k) {
+                for (size_t j = 0; j < rhs.cols(); ++j) {
+                    result(i, j) += static_cast<T>(lhs(i, k)) * static_cast<T>(rhs(k, j));
+                }
+            }
+        }
+    }
+    return result;
+}
+
+// 矩阵 × 向量；x只物化一次，因为它的每个元素会被每一行读取
+template<typename MatExpr, typename VecExpr>
+Vector<detail::common_value_t<MatExpr, VecExpr>> operator*(const MatrixExpression<MatExpr>& lhs,
+                                                           const VectorExpression<VecExpr>& rhs) {
+    using T = detail::common_value_t<MatExpr, VecExpr>;
+    if (lhs.cols() != rhs.size()) {
+        throw std::invalid_argument("矩阵与向量维度不匹配");
+    }
+    Vector<T> x(rhs.size(), uninitialized);
+    detail::evaluateRange(x.data(), static_cast<const VecExpr&>(rhs), 0, x.size());
+    Vector<T> result(lhs.rows(), uninitialized);
+    detail::simdDispatch<detail::GemvKernel>(result.data(), static_cast<const MatExpr&>(lhs),
+                                             static_cast<const T*>(x.data()));
+    return result;
+}
+
+// 朴素三重循环，作为分块内核的正确性与性能基准
+template<typename LhsExpr, typename RhsExpr>
+Matrix<detail::common_value_t<LhsExpr, RhsExpr>> multiplyNaive(const MatrixExpression<LhsExpr>& lhs,
+                                                               const MatrixExpression<RhsExpr>& rhs) {
+    using T = detail::common_value_t<LhsExpr, RhsExpr>;
+    if (lhs.cols() != rhs.rows()) {
+        throw std::invalid_argument("矩阵乘法维度不匹配");
+    }
+    Matrix<T> result(lhs.rows(), rhs.cols());
+    for (size_t i = 0; i < lhs.rows(); ++i) {
+        for (size_t j = 0; j < rhs.cols(); ++j) {
+            T s = T(0);
+            for (size_t k = 0; k < lhs.cols(); ++k) {
+                s += static_cast<T>(lhs(i, k)) * static_cast<T>(rhs(k, j));
+            }
+            result(i, j) = s;
+        }
+    }
+    return result;
+}
+
+// ========================
+// 辅助函数
+// ========================
+
+// 打印矩阵
+template<typename T>
+void printMatrix(const Matrix<T>& m, const std::string& name, size_t maxDisplay = 6) {
+    std::cout << name << " (" << m.rows() << "x" << m.cols() << ") =" << std::endl;
+    for (size_t r = 0; r < m.rows() && r < maxDisplay; ++r) {
+        std::cout << "  [";
+        for (size_t c = 0; c < m.cols() && c < maxDisplay; ++c) {
+            if (c > 0) std::cout << ", ";
+            std::cout << m(r, c);
+        }
+        if (m.cols() > maxDisplay) {
+            std::cout << ", ...";
+        }
+        std::cout << "]" << std::endl;
+    }
+    if (m.rows() > maxDisplay) {
+        std::cout << "  ..." << std::endl;
+    }
+}
+
+// 比较分块GEMM与朴素三重循环
+template<size_t Size>
+void compareGemmPerformance() {
+    Matrix<double> a(Size, Size);
+    Matrix<double> b(Size, Size);
+    for (size_t r = 0; r < Size; ++r) {
+        for (size_t c = 0; c < Size; ++c) {
+            a(r, c) = static_cast<double>((r * 7 + c * 3) % 11) - 5.0;
+            b(r, c) = static_cast<double>((r * 5 + c * 2) % 13) - 6.0;
+        }
+    }
+
+    Matrix<double> blocked, naive;
+    {
+        Timer t("分块GEMM " + std::to_string(Size) + "x" + std::to_string(Size));
+        blocked = a * b;
+    }
+    {
+        Timer t("朴素三重循环 " + std::to_string(Size) + "x" + std::to_string(Size));
+        naive = multiplyNaive(a, b);
+    }
+
+    bool correct = true;
+    for (size_t r = 0; r < Size && correct; ++r) {
+        for (size_t c = 0; c < Size; ++c) {
+            if (std::abs(blocked(r, c) - naive(r, c)) > 1e-9) {
+                correct = false;
+                break;
+            }
+        }
+    }
+    std::cout << "结果匹配: " << (correct ? "是" : "否") << std::endl;
+}
+
+} // namespace ExpressionTemplates
+
+#endif // MATRIX_HPP
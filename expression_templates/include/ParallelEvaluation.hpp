@@ -0,0 +1,260 @@
+// ParallelEvaluation.hpp
+#ifndef PARALLEL_EVALUATION_HPP
+#define PARALLEL_EVALUATION_HPP
+
+#include <cstddef>
+#include <cstdlib>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <exception>
+#include <algorithm>
+
+#include "SimdPacket.hpp"
+
+namespace ExpressionTemplates {
+
+// 用作重载标签：result.assign(expr, parallel)
+struct ParallelTag {};
+inline constexpr ParallelTag parallel{};
+
+// ========================
+// 固定大小的线程池
+// ========================
+// 调用线程也参与计算：run()把[0, chunks)的任务块通过原子计数器分发，
+// 各线程自行领取，直到全部领完
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t workers) {
+        threads_.reserve(workers);
+        for (size_t i = 0; i < workers; ++i) {
+            threads_.emplace_back([this, i] { workerLoop(i + 1); });
+        }
+    }
+
+    // 条款8: 别让异常逃离析构函数
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto& t : threads_) {
+            t.join();
+        }
+    }
+
+    // 条款6: 若不想使用编译器自动生成的函数，就该明确拒绝
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // 全局共享的线程池，线程数取 ET_NUM_THREADS 或硬件并发数
+    static ThreadPool& instance() {
+        static ThreadPool pool(defaultWorkerCount());
+        return pool;
+    }
+
+    // 后台线程数（不含调用线程）
+    size_t workerCount() const {
+        return threads_.size();
+    }
+
+    // 当前线程编号：0 表示调用线程，1..workerCount() 表示池内线程
+    static size_t currentThreadIndex() {
+        return threadIndex();
+    }
+
+    // 对每个 c ∈ [0, chunks) 调用 task(c)，阻塞直到全部完成
+    // 任务内抛出的第一个异常会在调用线程重新抛出
+    void run(size_t chunks, const std::function<void(size_t)>& task) {
+        // 任务内再次并行会死锁：池内线程在等待新任务之前不会回来领取，
+        // 调用线程也在 drainChunks() 中执行任务，会第二次锁住 runMutex_。
+        // 因此在任何正在执行 run() 的线程上（包括调用线程）都直接串行执行
+        if (threads_.empty() || chunks <= 1 || insideRun()) {
+            for (size_t c = 0; c < chunks; ++c) {
+                task(c);
+            }
+            return;
+        }
+
+        RunScope scope;
+        std::lock_guard<std::mutex> runLock(runMutex_);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            task_ = &task;
+            chunkCount_ = chunks;
+            nextChunk_.store(0, std::memory_order_relaxed);
+            pending_ = threads_.size();
+            error_ = nullptr;
+            ++generation_;
+        }
+        wake_.notify_all();
+
+        drainChunks();
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return pending_ == 0; });
+        task_ = nullptr;
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+    }
+
+private:
+    static size_t defaultWorkerCount() {
+        size_t threads = std::thread::hardware_concurrency();
+        if (const char* env = std::getenv("ET_NUM_THREADS")) {
+            threads = static_cast<size_t>(std::strtoul(env, nullptr, 10));
+        }
+        return threads > 1 ? threads - 1 : 0;
+    }
+
+    static size_t& threadIndex() {
+        thread_local size_t index = 0;
+        return index;
+    }
+
+    // 当前线程是否正在 run() 中：池内线程始终为真，调用线程只在 run() 期间为真
+    static bool& insideRun() {
+        thread_local bool inside = false;
+        return inside;
+    }
+
+    // 条款13: 以对象管理资源，异常从 run() 传出时也会清除标记
+    struct RunScope {
+        RunScope() {
+            insideRun() = true;
+        }
+
+        ~RunScope() {
+            insideRun() = false;
+        }
+
+        RunScope(const RunScope&) = delete;
+        RunScope& operator=(const RunScope&) = delete;
+    };
+
+    void drainChunks() {
+        for (;;) {
+            size_t c = nextChunk_.fetch_add(1, std::memory_order_relaxed);
+            if (c >= chunkCount_) {
+                return;
+            }
+            try {
+                (*task_)(c);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!error_) {
+                    error_ = std::current_exception();
+                }
+            }
+        }
+    }
+
+    void workerLoop(size_t index) {
+        threadIndex() = index;
+        insideRun() = true;
+        unsigned long long seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                if (stop_) {
+                    return;
+                }
+                seen = generation_;
+            }
+            drainChunks();
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                --pending_;
+            }
+            done_.notify_one();
+        }
+    }
+
+    std::vector<std::thread> threads_;
+    std::mutex runMutex_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const std::function<void(size_t)>* task_ = nullptr;
+    size_t chunkCount_ = 0;
+    std::atomic<size_t> nextChunk_{0};
+    size_t pending_ = 0;
+    unsigned long long generation_ = 0;
+    bool stop_ = false;
+    std::exception_ptr error_;
+};
+
+// ========================
+// 并行求值的可调参数
+// ========================
+namespace detail {
+
+inline std::atomic<size_t>& parallelThresholdStorage() {
+    static std::atomic<size_t> threshold{1 << 16};
+    return threshold;
+}
+
+inline std::atomic<size_t>& parallelChunkBytesStorage() {
+    static std::atomic<size_t> bytes{64 * 1024};
+    return bytes;
+}
+
+} // namespace detail
+
+// 元素数低于该阈值时回退为串行求值
+inline size_t parallelThreshold() {
+    return detail::parallelThresholdStorage().load(std::memory_order_relaxed);
+}
+
+inline void setParallelThreshold(size_t elements) {
+    detail::parallelThresholdStorage().store(elements, std::memory_order_relaxed);
+}
+
+// 每个任务块写入的字节数，默认64KB，能放进L2
+inline size_t parallelChunkBytes() {
+    return detail::parallelChunkBytesStorage().load(std::memory_order_relaxed);
+}
+
+inline void setParallelChunkBytes(size_t bytes) {
+    detail::parallelChunkBytesStorage().store(bytes, std::memory_order_relaxed);
+}
+
+namespace detail {
+
+// 任务块的元素数：按缓存行取整，相邻线程不会写同一缓存行
+template<typename T>
+size_t parallelChunkSize() {
+    constexpr size_t line = 64 / sizeof(T) > 0 ? 64 / sizeof(T) : 1;
+    size_t elements = std::max(parallelChunkBytes() / sizeof(T), line);
+    return (elements + line - 1) / line * line;
+}
+
+// 把 [0, n) 切成块，在线程池中并行调用 evaluateRange
+// 每个元素仍只对表达式树求值一次，不产生任何临时向量
+template<typename T, typename Expr>
+void evaluateParallel(T* dst, const Expr& expr, size_t n) {
+    ThreadPool& pool = ThreadPool::instance();
+    if (n < parallelThreshold() || pool.workerCount() == 0) {
+        evaluateRange(dst, expr, 0, n);
+        return;
+    }
+
+    const size_t chunk = parallelChunkSize<T>();
+    const size_t chunks = (n + chunk - 1) / chunk;
+    pool.run(chunks, [&](size_t c) {
+        size_t begin = c * chunk;
+        evaluateRange(dst, expr, begin, std::min(n, begin + chunk));
+    });
+}
+
+} // namespace detail
+
+} // namespace ExpressionTemplates
+
+#endif // PARALLEL_EVALUATION_HPP
@@ -0,0 +1,617 @@
+// Reductions.hpp
+#ifndef REDUCTIONS_HPP
+#define REDUCTIONS_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "ExpressionTemplates.hpp"
+#include "ElementwiseOps.hpp"
+
+namespace ExpressionTemplates {
+
+// 归约直接消费表达式树：sum(a - b)、dot(a - b, a - b) 都只遍历一遍，
+// 不会先物化成 Vector<double>
+
+// 求和方式。长向量逐个累加时舍入误差随元素个数增长，
+// 以下几种方式都仍然按packet求值，不必为了精度退回到串行的 long double 循环：
+//   sum(a * b, Summation::Neumaier)
+enum class Summation {
+    Naive,     // 四组累加器直接相加（默认），最快，误差上界与元素个数成正比
+    Kahan,     // Kahan 补偿求和，误差上界与元素个数无关；被加数大于部分和时补偿失效
+    Neumaier,  // Neumaier 改进的补偿求和，任意量级的被加数都能补偿，比 Kahan 多一次比较选择
+    Pairwise   // 分块两两求和，误差上界随 log(n) 增长，开销几乎与 Naive 相同
+};
+
+namespace detail {
+
+// ========================
+// 归约操作
+// ========================
+template<typename T>
+struct SumOp {
+    static T identity() { return T(0); }
+    static T combine(T a, T b) { return a + b; }
+
+    template<size_t N>
+    static ET_ALWAYS_INLINE Packet<T, N> combine(const Packet<T, N>& a, const Packet<T, N>& b) {
+        return a + b;
+    }
+};
+
+// 浮点数以无穷大作单位元，整数以极值作单位元
+template<typename T>
+T largestValue() {
+    if constexpr (std::numeric_limits<T>::has_infinity) {
+        return std::numeric_limits<T>::infinity();
+    } else {
+        return std::numeric_limits<T>::max();
+    }
+}
+
+template<typename T>
+T smallestValue() {
+    if constexpr (std::numeric_limits<T>::has_infinity) {
+        return -std::numeric_limits<T>::infinity();
+    } else {
+        return std::numeric_limits<T>::lowest();
+    }
+}
+
+template<typename T>
+struct MinOp {
+    static T identity() { return largestValue<T>(); }
+    static T combine(T a, T b) { return a < b ? a : b; }
+
+    template<size_t N>
+    static ET_ALWAYS_INLINE Packet<T, N> combine(const Packet<T, N>& a, const Packet<T, N>& b) {
+        return min(a, b);
+    }
+};
+
+template<typename T>
+struct MaxOp {
+    static T identity() { return smallestValue<T>(); }
+    static T combine(T a, T b) { return a > b ? a : b; }
+
+    template<size_t N>
+    static ET_ALWAYS_INLINE Packet<T, N> combine(const Packet<T, N>& a, const Packet<T, N>& b) {
+        return max(a, b);
+    }
+};
+
+// ========================
+// 归约内核
+// ========================
+// 四个互不依赖的累加器让加法延迟互相重叠（指令级并行），
+// SIMD版本的每个累加器是一个寄存器，最后再做水平归约。
+// 累加在表达式自身的值类型中进行：float表达式用float累加器，寄存器里能放下两倍的元素
+template<template<typename> class Op>
+struct ReduceKernel {
+    template<size_t Bytes, typename Expr>
+    static ET_ALWAYS_INLINE expression_value_t<Expr> run(const Expr& expr, size_t begin, size_t end) {
+        using T = expression_value_t<Expr>;
+        using O = Op<T>;
+        size_t i = begin;
+        T acc0 = O::identity();
+        T acc1 = O::identity();
+        T acc2 = O::identity();
+        T acc3 = O::identity();
+
+        constexpr size_t N = packetLanes<Bytes, Expr>();
+        if constexpr (N != 0) {
+            using P = Packet<T, N>;
+            P p0 = P::broadcast(O::identity());
+            P p1 = p0;
+            P p2 = p0;
+            P p3 = p0;
+            for (; i + 4 * N <= end; i += 4 * N) {
+                p0 = O::combine(p0, expr.template packet<N>(i));
+                p1 = O::combine(p1, expr.template packet<N>(i + N));
+                p2 = O::combine(p2, expr.template packet<N>(i + 2 * N));
+                p3 = O::combine(p3, expr.template packet<N>(i + 3 * N));
+            }
+            for (; i + N <= end; i += N) {
+                p0 = O::combine(p0, expr.template packet<N>(i));
+            }
+            P folded = O::combine(O::combine(p0, p1), O::combine(p2, p3));
+            for (size_t k = 0; k < N; ++k) {
+                acc0 = O::combine(acc0, folded[k]);
+            }
+        } else {
+            for (; i + 4 <= end; i += 4) {
+                acc0 = O::combine(acc0, expr[i]);
+                acc1 = O::combine(acc1, expr[i + 1]);
+                acc2 = O::combine(acc2, expr[i + 2]);
+                acc3 = O::combine(acc3, expr[i + 3]);
+            }
+        }
+        for (; i < end; ++i) {
+            acc0 = O::combine(acc0, expr[i]);
+        }
+        return O::combine(O::combine(acc0, acc1), O::combine(acc2, acc3));
+    }
+};
+
+// any/all 的内核：每次检查一组packet，找到结果后立即退出
+template<bool All>
+struct PredicateKernel {
+    template<size_t Bytes, typename Expr>
+    static ET_ALWAYS_INLINE bool run(const Expr& expr, size_t begin, size_t end) {
+        using T = expression_value_t<Expr>;
+        size_t i = begin;
+        constexpr size_t N = packetLanes<Bytes, Expr>();
+        if constexpr (N != 0) {
+            for (; i + N <= end; i += N) {
+                auto p = expr.template packet<N>(i);
+                if (All ? !p.allNonZero() : p.anyNonZero()) {
+                    return !All;
+                }
+            }
+        }
+        for (; i < end; ++i) {
+            if ((expr[i] != T(0)) != All) {
+                return !All;
+            }
+        }
+        return All;
+    }
+};
+
+// 定长表达式直接用标量内核，长度是编译期常量，循环会被完全展开，也省去运行时分派
+template<template<typename> class Op, typename Expr>
+expression_value_t<Expr> reduce(const Expr& expr) {
+    if constexpr (ExpressionTraits<Expr>::static_size != 0) {
+        return ReduceKernel<Op>::template run<0>(expr, 0, ExpressionTraits<Expr>::static_size);
+    } else {
+        return simdDispatch<ReduceKernel<Op>>(expr, size_t{0}, expr.size());
+    }
+}
+
+// 每个任务块得到一个部分结果，最后按块的顺序合并，结果与线程数无关
+template<template<typename> class Op, typename Expr>
+expression_value_t<Expr> reduce(const Expr& expr, ParallelTag) {
+    using T = expression_value_t<Expr>;
+    const size_t n = expr.size();
+    ThreadPool& pool = ThreadPool::instance();
+    if (n < parallelThreshold() || pool.workerCount() == 0) {
+        return reduce<Op>(expr);
+    }
+
+    const size_t chunk = parallelChunkSize<T>();
+    const size_t chunks = (n + chunk - 1) / chunk;
+    std::vector<T> partial(chunks);
+    pool.run(chunks, [&](size_t c) {
+        size_t begin = c * chunk;
+        partial[c] = simdDispatch<ReduceKernel<Op>>(expr, begin, std::min(n, begin + chunk));
+    });
+
+    T result = Op<T>::identity();
+    for (T p : partial) {
+        result = Op<T>::combine(result, p);
+    }
+    return result;
+}
+
+template<bool All, typename Expr>
+bool testAll(const Expr& expr) {
+    if constexpr (ExpressionTraits<Expr>::static_size != 0) {
+        return PredicateKernel<All>::template run<0>(expr, 0, ExpressionTraits<Expr>::static_size);
+    } else {
+        return simdDispatch<PredicateKernel<All>>(expr, size_t{0}, expr.size());
+    }
+}
+
+template<bool All, typename Expr>
+bool testAll(const Expr& expr, ParallelTag) {
+    const size_t n = expr.size();
+    ThreadPool& pool = ThreadPool::instance();
+    if (n < parallelThreshold() || pool.workerCount() == 0) {
+        return testAll<All>(expr);
+    }
+
+    // 一旦某个块得出结论，其余未开始的块直接跳过
+    const size_t chunk = parallelChunkSize<expression_value_t<Expr>>();
+    const size_t chunks = (n + chunk - 1) / chunk;
+    std::atomic<bool> decided{false};
+    pool.run(chunks, [&](size_t c) {
+        if (decided.load(std::memory_order_relaxed)) {
+            return;
+        }
+        size_t begin = c * chunk;
+        if (simdDispatch<PredicateKernel<All>>(expr, begin, std::min(n, begin + chunk)) != All) {
+            decided.store(true, std::memory_order_relaxed);
+        }
+    });
+    return decided.load() ? !All : All;
+}
+
+// count 的内核：非零通道按1/0累加在与元素同宽的整数packet里，
+// 每个通道的计数到达该整数类型的最大值之前合并到 size_t，int8 的掩码也不会溢出
+struct CountKernel {
+    template<size_t Bytes, typename Expr>
+    static ET_ALWAYS_INLINE size_t run(const Expr& expr, size_t begin, size_t end) {
+        using T = expression_value_t<Expr>;
+        size_t total = 0;
+        size_t i = begin;
+        constexpr size_t N = packetLanes<Bytes, Expr>();
+        if constexpr (N != 0) {
+            using P = Packet<T, N>;
+            using M = typename P::mask_type;
+            constexpr size_t block = static_cast<size_t>(std::numeric_limits<mask_value_t<T>>::max());
+            const P zero = P::broadcast(T(0));
+            while (i + N <= end) {
+                const size_t stop = i + std::min(block, (end - i) / N) * N;
+                M counts = M::broadcast(0);
+                for (; i < stop; i += N) {
+                    counts = counts + (expr.template packet<N>(i) != zero);
+                }
+                for (size_t k = 0; k < N; ++k) {
+                    total += static_cast<size_t>(counts[k]);
+                }
+            }
+        }
+        for (; i < end; ++i) {
+            total += expr[i] != T(0) ? 1 : 0;
+        }
+        return total;
+    }
+};
+
+template<typename Expr>
+size_t countNonZero(const Expr& expr) {
+    if constexpr (ExpressionTraits<Expr>::static_size != 0) {
+        return CountKernel::template run<0>(expr, 0, ExpressionTraits<Expr>::static_size);
+    } else {
+        return simdDispatch<CountKernel>(expr, size_t{0}, expr.size());
+    }
+}
+
+template<typename Expr>
+size_t countNonZero(const Expr& expr, ParallelTag) {
+    const size_t n = expr.size();
+    ThreadPool& pool = ThreadPool::instance();
+    if (n < parallelThreshold() || pool.workerCount() == 0) {
+        return countNonZero(expr);
+    }
+
+    const size_t chunk = parallelChunkSize<expression_value_t<Expr>>();
+    const size_t chunks = (n + chunk - 1) / chunk;
+    std::vector<size_t> partial(chunks);
+    pool.run(chunks, [&](size_t c) {
+        size_t begin = c * chunk;
+        partial[c] = simdDispatch<CountKernel>(expr, begin, std::min(n, begin + chunk));
+    });
+    size_t total = 0;
+    for (size_t p : partial) {
+        total += p;
+    }
+    return total;
+}
+
+// ========================
+// 高精度求和
+// ========================
+// 补偿求和与分块两两求和的结果：真实的和约等于 sum + compensation
+template<typename T>
+struct CompensatedValue {
+    T sum;
+    T compensation;
+};
+
+// Neumaier 的一步：无论 x 与部分和哪个绝对值更大，都能找回被舍去的低位
+template<typename T>
+ET_ALWAYS_INLINE void neumaierAdd(T& sum, T& compensation, T x) {
+    T t = sum + x;
+    compensation += std::abs(sum) >= std::abs(x) ? (sum - t) + x : (x - t) + sum;
+    sum = t;
+}
+
+template<typename T, size_t N>
+ET_ALWAYS_INLINE void neumaierAdd(Packet<T, N>& sum, Packet<T, N>& compensation,
+                                  const Packet<T, N>& x) {
+    Packet<T, N> t = sum + x;
+    compensation = compensation + select(packetAbs(sum) >= packetAbs(x), (sum - t) + x,
+                                         (x - t) + sum);
+    sum = t;
+}
+
+// Kahan 的一步：compensation 记录上一次加法丢失的部分（取负），下一次加法前先扣除
+template<typename T>
+ET_ALWAYS_INLINE void kahanAdd(T& sum, T& compensation, T x) {
+    T y = x - compensation;
+    T t = sum + y;
+    compensation = (t - sum) - y;
+    sum = t;
+}
+
+template<typename T, size_t N>
+ET_ALWAYS_INLINE void kahanAdd(Packet<T, N>& sum, Packet<T, N>& compensation,
+                               const Packet<T, N>& x) {
+    Packet<T, N> y = x - compensation;
+    Packet<T, N> t = sum + y;
+    compensation = (t - sum) - y;
+    sum = t;
+}
+
+// 补偿求和内核：每个通道各自做 Kahan/Neumaier，两组互不依赖的累加器重叠延迟，
+// 最后把所有通道的部分和再做一次 Neumaier 合并
+template<bool Neumaier>
+struct CompensatedSumKernel {
+    template<typename S>
+    static ET_ALWAYS_INLINE void add(S& sum, S& compensation, const S& x) {
+        if constexpr (Neumaier) {
+            neumaierAdd(sum, compensation, x);
+        } else {
+            kahanAdd(sum, compensation, x);
+        }
+    }
+
+    template<size_t Bytes, typename Expr>
+    static ET_ALWAYS_INLINE CompensatedValue<expression_value_t<Expr>> run(const Expr& expr,
+                                                                             size_t begin,
+                                                                             size_t end) {
+        using T = expression_value_t<Expr>;
+        // Kahan 的 compensation 是负的误差，合并时统一换成 Neumaier 的符号
+        constexpr T sign = Neumaier ? T(1) : T(-1);
+        size_t i = begin;
+        T sum = T(0);
+        T compensation = T(0);
+        T tailCompensation = T(0);
+
+        constexpr size_t N = packetLanes<Bytes, Expr>();
+        if constexpr (N != 0) {
+            using P = Packet<T, N>;
+            P s0 = P::broadcast(T(0));
+            P c0 = s0;
+            P s1 = s0;
+            P c1 = s0;
+            for (; i + 2 * N <= end; i += 2 * N) {
+                add(s0, c0, expr.template packet<N>(i));
+                add(s1, c1, expr.template packet<N>(i + N));
+            }
+            for (; i + N <= end; i += N) {
+                add(s0, c0, expr.template packet<N>(i));
+            }
+            for (size_t k = 0; k < N; ++k) {
+                neumaierAdd(sum, compensation, s0[k]);
+                neumaierAdd(sum, compensation, s1[k]);
+                compensation += sign * (c0[k] + c1[k]);
+            }
+        }
+        T tail = T(0);
+        for (; i < end; ++i) {
+            add(tail, tailCompensation, static_cast<T>(expr[i]));
+        }
+        neumaierAdd(sum, compensation, tail);
+        compensation += sign * tailCompensation;
+        return CompensatedValue<T>{sum, compensation};
+    }
+};
+
+// 分块两两求和：每块 blockElements 个元素用普通的SIMD内核求和，块的和再按二叉树两两相加。
+// 二叉树用一个二进制计数器维护：第 b 块加入时，b 的末尾有几个1就合并几次，
+// 栈中最多 log2(块数) 个部分和，不需要递归也不需要额外内存
+struct PairwiseSumKernel {
+    static constexpr size_t blockElements = 256;
+
+    template<size_t Bytes, typename Expr>
+    static ET_ALWAYS_INLINE CompensatedValue<expression_value_t<Expr>> run(const Expr& expr,
+                                                                             size_t begin,
+                                                                             size_t end) {
+        using T = expression_value_t<Expr>;
+        T stack[64];
+        size_t depth = 0;
+        size_t blocks = 0;
+        for (size_t i = begin; i < end; i += blockElements) {
+            T partial = ReduceKernel<SumOp>::template run<Bytes>(expr, i,
+                                                                 std::min(end, i + blockElements));
+            for (size_t b = blocks; b & 1; b >>= 1) {
+                partial = stack[--depth] + partial;
+            }
+            stack[depth++] = partial;
+            ++blocks;
+        }
+        T sum = T(0);
+        while (depth > 0) {
+            sum = stack[--depth] + sum;
+        }
+        return CompensatedValue<T>{sum, T(0)};
+    }
+};
+
+template<Summation Mode, typename Expr>
+CompensatedValue<expression_value_t<Expr>> accurateSumRange(const Expr& expr, size_t begin,
+                                                             size_t end) {
+    using Kernel = std::conditional_t<
+        Mode == Summation::Pairwise, PairwiseSumKernel,
+        CompensatedSumKernel<Mode == Summation::Neumaier>>;
+    if constexpr (ExpressionTraits<Expr>::static_size != 0) {
+        return Kernel::template run<0>(expr, begin, end);
+    } else {
+        return simdDispatch<Kernel>(expr, begin, end);
+    }
+}
+
+// 按块并行时各块的部分结果按块的顺序用 Neumaier 合并，结果与线程数无关
+template<Summation Mode, typename Expr>
+expression_value_t<Expr> accurateSum(const Expr& expr, bool parallelize) {
+    using T = expression_value_t<Expr>;
+    const size_t n = expr.size();
+    ThreadPool& pool = ThreadPool::instance();
+    if (!parallelize || n < parallelThreshold() || pool.workerCount() == 0) {
+        CompensatedValue<T> r = accurateSumRange<Mode>(expr, 0, n);
+        return r.sum + r.compensation;
+    }
+
+    const size_t chunk = parallelChunkSize<T>();
+    const size_t chunks = (n + chunk - 1) / chunk;
+    std::vector<CompensatedValue<T>> partial(chunks);
+    pool.run(chunks, [&](size_t c) {
+        size_t begin = c * chunk;
+        partial[c] = accurateSumRange<Mode>(expr, begin, std::min(n, begin + chunk));
+    });
+
+    T sum = T(0);
+    T compensation = T(0);
+    for (const CompensatedValue<T>& p : partial) {
+        neumaierAdd(sum, compensation, p.sum);
+        compensation += p.compensation;
+    }
+    return sum + compensation;
+}
+
+// 按运行时选择的方式求和；整数求和没有舍入误差，总是直接相加
+template<typename Expr>
+expression_value_t<Expr> sumWith(const Expr& expr, Summation mode, bool parallelize) {
+    if constexpr (std::is_floating_point_v<expression_value_t<Expr>>) {
+        switch (mode) {
+            case Summation::Kahan:
+                return accurateSum<Summation::Kahan>(expr, parallelize);
+            case Summation::Neumaier:
+                return accurateSum<Summation::Neumaier>(expr, parallelize);
+            case Summation::Pairwise:
+                return accurateSum<Summation::Pairwise>(expr, parallelize);
+            default:
+                break;
+        }
+    }
+    return parallelize ? reduce<SumOp>(expr, parallel) : reduce<SumOp>(expr);
+}
+
+template<typename Expr>
+void requireNonEmpty(const Expr& expr, const char* what) {
+    if (expr.size() == 0) {
+        throw std::invalid_argument(what);
+    }
+}
+
+} // namespace detail
+
+// ========================
+// 归约函数
+// ========================
+
+// 所有元素之和
+template<typename Expr>
+expression_value_t<Expr> sum(const VectorExpression<Expr>& expr) {
+    return detail::reduce<detail::SumOp>(static_cast<const Expr&>(expr));
+}
+
+template<typename Expr>
+expression_value_t<Expr> sum(const VectorExpression<Expr>& expr, ParallelTag tag) {
+    return detail::reduce<detail::SumOp>(static_cast<const Expr&>(expr), tag);
+}
+
+// 指定求和方式，见 Summation
+template<typename Expr>
+expression_value_t<Expr> sum(const VectorExpression<Expr>& expr, Summation mode) {
+    return detail::sumWith(static_cast<const Expr&>(expr), mode, false);
+}
+
+template<typename Expr>
+expression_value_t<Expr> sum(const VectorExpression<Expr>& expr, Summation mode, ParallelTag) {
+    return detail::sumWith(static_cast<const Expr&>(expr), mode, true);
+}
+
+// 内积，乘法与加法融合在同一次遍历中
+template<typename LhsExpr, typename RhsExpr>
+detail::common_value_t<LhsExpr, RhsExpr> dot(const VectorExpression<LhsExpr>& lhs, const VectorExpression<RhsExpr>& rhs) {
+    return detail::reduce<detail::SumOp>(lhs * rhs);
+}
+
+template<typename LhsExpr, typename RhsExpr>
+detail::common_value_t<LhsExpr, RhsExpr> dot(const VectorExpression<LhsExpr>& lhs, const VectorExpression<RhsExpr>& rhs,
+           ParallelTag tag) {
+    return detail::reduce<detail::SumOp>(lhs * rhs, tag);
+}
+
+template<typename LhsExpr, typename RhsExpr>
+detail::common_value_t<LhsExpr, RhsExpr> dot(const VectorExpression<LhsExpr>& lhs, const VectorExpression<RhsExpr>& rhs,
+           Summation mode) {
+    return detail::sumWith(lhs * rhs, mode, false);
+}
+
+template<typename LhsExpr, typename RhsExpr>
+detail::common_value_t<LhsExpr, RhsExpr> dot(const VectorExpression<LhsExpr>& lhs, const VectorExpression<RhsExpr>& rhs,
+           Summation mode, ParallelTag) {
+    return detail::sumWith(lhs * rhs, mode, true);
+}
+
+// 欧几里得范数 sqrt(Σx²)，浮点表达式保持自身精度
+template<typename Expr>
+auto norm2(const VectorExpression<Expr>& expr) {
+    return std::sqrt(dot(expr, expr));
+}
+
+template<typename Expr>
+auto norm2(const VectorExpression<Expr>& expr, ParallelTag tag) {
+    return std::sqrt(dot(expr, expr, tag));
+}
+
+// 最小/最大元素，空表达式抛出异常
+template<typename Expr>
+expression_value_t<Expr> min(const VectorExpression<Expr>& expr) {
+    detail::requireNonEmpty(expr, "空向量没有最小值");
+    return detail::reduce<detail::MinOp>(static_cast<const Expr&>(expr));
+}
+
+template<typename Expr>
+expression_value_t<Expr> min(const VectorExpression<Expr>& expr, ParallelTag tag) {
+    detail::requireNonEmpty(expr, "空向量没有最小值");
+    return detail::reduce<detail::MinOp>(static_cast<const Expr&>(expr), tag);
+}
+
+template<typename Expr>
+expression_value_t<Expr> max(const VectorExpression<Expr>& expr) {
+    detail::requireNonEmpty(expr, "空向量没有最大值");
+    return detail::reduce<detail::MaxOp>(static_cast<const Expr&>(expr));
+}
+
+template<typename Expr>
+expression_value_t<Expr> max(const VectorExpression<Expr>& expr, ParallelTag tag) {
+    detail::requireNonEmpty(expr, "空向量没有最大值");
+    return detail::reduce<detail::MaxOp>(static_cast<const Expr&>(expr), tag);
+}
+
+// 是否存在非零元素
+template<typename Expr>
+bool any(const VectorExpression<Expr>& expr) {
+    return detail::testAll<false>(static_cast<const Expr&>(expr));
+}
+
+template<typename Expr>
+bool any(const VectorExpression<Expr>& expr, ParallelTag tag) {
+    return detail::testAll<false>(static_cast<const Expr&>(expr), tag);
+}
+
+// 是否所有元素都非零（空表达式为true）
+template<typename Expr>
+bool all(const VectorExpression<Expr>& expr) {
+    return detail::testAll<true>(static_cast<const Expr&>(expr));
+}
+
+template<typename Expr>
+bool all(const VectorExpression<Expr>& expr, ParallelTag tag) {
+    return detail::testAll<true>(static_cast<const Expr&>(expr), tag);
+}
+
+// 非零元素的个数，按 size_t 计数：count(a > b) 是满足条件的元素个数。
+// sum(a > b) 在掩码类型中累加，元素小于4字节时掩码是 int8/int16，计数会溢出
+template<typename Expr>
+size_t count(const VectorExpression<Expr>& expr) {
+    return detail::countNonZero(static_cast<const Expr&>(expr));
+}
+
+template<typename Expr>
+size_t count(const VectorExpression<Expr>& expr, ParallelTag tag) {
+    return detail::countNonZero(static_cast<const Expr&>(expr), tag);
+}
+
+} // namespace ExpressionTemplates
+
+#endif // REDUCTIONS_HPP
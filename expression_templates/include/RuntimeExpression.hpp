@@ -0,0 +1,698 @@
+// RuntimeExpression.hpp
+#ifndef RUNTIME_EXPRESSION_HPP
+#define RUNTIME_EXPRESSION_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "ExpressionTemplates.hpp"
+#include "AlignedBuffer.hpp"
+#include "ElementwiseOps.hpp"
+#include "SharedExpression.hpp"
+
+namespace ExpressionTemplates {
+
+// ========================
+// 运行时表达式图
+// ========================
+// 表达式模板要求公式在编译期已知。公式来自配置文件时，先在运行时建立表达式图，
+// 再编译成线性的字节码，按块（每条指令一次处理 chunkElements 个元素）解释执行：
+//   ExpressionGraph<double> g;
+//   auto x = g.input(a);
+//   auto y = g.input(b);
+//   CompiledExpression<double> f = g.compile(x * g.constant(2.0) + exp(y));
+//   Vector<double> result = f;            // 也可以 result.assign(f, parallel)
+// 每条指令在一块上调用一次SIMD内核，解释的开销（取指令、分派）被一块的元素数分摊。
+// 中间结果保存在每块大小的寄存器里，寄存器在最后一次使用后立即复用，工作集留在L1/L2中
+//
+// 图只保存输入向量的指针：编译后的表达式求值时，输入向量必须仍然存在
+
+// 字节码的运算
+enum class Opcode {
+    Add, Subtract, Multiply, Divide, Minimum, Maximum,  // 二元算术
+    Less, Greater,                                      // 比较，真为1、假为0
+    Select,                                             // Select(m, x, y) = m != 0 ? x : y
+    Negate, Abs, Square, Sqrt, Exp, Log, Sin, Cos, Tanh // 一元运算
+};
+
+// 运算需要的操作数个数
+inline size_t opcodeArity(Opcode op) {
+    switch (op) {
+        case Opcode::Select:
+            return 3;
+        case Opcode::Negate:
+        case Opcode::Abs:
+        case Opcode::Square:
+        case Opcode::Sqrt:
+        case Opcode::Exp:
+        case Opcode::Log:
+        case Opcode::Sin:
+        case Opcode::Cos:
+        case Opcode::Tanh:
+            return 1;
+        default:
+            return 2;
+    }
+}
+
+template<typename T>
+class ExpressionGraph;
+
+template<typename T>
+class CompiledExpression;
+
+template<typename T>
+struct ExpressionTraits<CompiledExpression<T>> {
+    using value_type = T;
+    // 嵌在其他表达式里时按块解释到每个线程的缓存，再按packet读取
+    static constexpr bool vectorizable = detail::is_packet_type<T>;
+    static constexpr size_t static_size = 0;
+};
+
+namespace detail {
+
+// 编译后的表达式持有字节码，嵌入其他表达式时按引用保存，避免复制
+template<typename T>
+struct OperandStorage<CompiledExpression<T>> {
+    using type = const CompiledExpression<T>&;
+};
+
+// 乘以-1而不是用0减，-0.0 的符号与标量的 -x 一致
+struct NegateOp {
+    template<typename T>
+    static T apply(T x) {
+        return -x;
+    }
+
+    template<typename T, size_t N>
+    static ET_ALWAYS_INLINE Packet<T, N> applyPacket(const Packet<T, N>& x) {
+        return x * Packet<T, N>::broadcast(T(-1));
+    }
+};
+
+// 一条指令在一块上的循环：dst[j] = Op(a[j], b[j], ...)，dst 可以与某个操作数相同（原地运算）
+template<size_t Bytes, typename Op, typename T>
+ET_ALWAYS_INLINE void unaryLoop(T* dst, const T* a, size_t count) {
+    size_t j = 0;
+    if constexpr (Bytes != 0) {
+        constexpr size_t N = Bytes / sizeof(T);
+        using P = Packet<T, N>;
+        for (; j + N <= count; j += N) {
+            Op::applyPacket(P::load(a + j)).store(dst + j);
+        }
+    }
+    for (; j < count; ++j) {
+        dst[j] = static_cast<T>(Op::apply(a[j]));
+    }
+}
+
+template<size_t Bytes, typename Op, typename T>
+ET_ALWAYS_INLINE void binaryLoop(T* dst, const T* a, const T* b, size_t count) {
+    size_t j = 0;
+    if constexpr (Bytes != 0) {
+        constexpr size_t N = Bytes / sizeof(T);
+        using P = Packet<T, N>;
+        for (; j + N <= count; j += N) {
+            auto r = Op::applyPacket(P::load(a + j), P::load(b + j));
+            r.template cast<T>().store(dst + j);
+        }
+    }
+    for (; j < count; ++j) {
+        dst[j] = static_cast<T>(Op::apply(a[j], b[j]));
+    }
+}
+
+template<size_t Bytes, typename T>
+ET_ALWAYS_INLINE void selectLoop(T* dst, const T* mask, const T* a, const T* b, size_t count) {
+    size_t j = 0;
+    if constexpr (Bytes != 0) {
+        constexpr size_t N = Bytes / sizeof(T);
+        using P = Packet<T, N>;
+        const P zero = P::broadcast(T(0));
+        for (; j + N <= count; j += N) {
+            select(P::load(mask + j) != zero, P::load(a + j), P::load(b + j)).store(dst + j);
+        }
+    }
+    for (; j < count; ++j) {
+        dst[j] = mask[j] != T(0) ? a[j] : b[j];
+    }
+}
+
+// 解释器内核：执行一条指令。整个 switch 在每个SIMD目标函数中展开一次，
+// 分派的代价是每块每条指令一次间接跳转
+struct InstructionKernel {
+    template<size_t Bytes, typename T>
+    static ET_ALWAYS_INLINE void run(Opcode op, T* dst, const T* a, const T* b, const T* c,
+                                     size_t count) {
+        switch (op) {
+            case Opcode::Add: binaryLoop<Bytes, AddOp>(dst, a, b, count); break;
+            case Opcode::Subtract: binaryLoop<Bytes, SubtractOp>(dst, a, b, count); break;
+            case Opcode::Multiply: binaryLoop<Bytes, MultiplyOp>(dst, a, b, count); break;
+            case Opcode::Divide: binaryLoop<Bytes, DivideOp>(dst, a, b, count); break;
+            case Opcode::Minimum: binaryLoop<Bytes, MinimumOp>(dst, a, b, count); break;
+            case Opcode::Maximum: binaryLoop<Bytes, MaximumOp>(dst, a, b, count); break;
+            case Opcode::Less: binaryLoop<Bytes, LessOp>(dst, a, b, count); break;
+            case Opcode::Greater: binaryLoop<Bytes, GreaterOp>(dst, a, b, count); break;
+            case Opcode::Select: selectLoop<Bytes>(dst, a, b, c, count); break;
+            case Opcode::Negate: unaryLoop<Bytes, NegateOp>(dst, a, count); break;
+            case Opcode::Abs: unaryLoop<Bytes, AbsOp>(dst, a, count); break;
+            case Opcode::Square: unaryLoop<Bytes, SquareOp>(dst, a, count); break;
+            case Opcode::Sqrt: unaryLoop<Bytes, SqrtOp>(dst, a, count); break;
+            case Opcode::Exp: unaryLoop<Bytes, ExpOp>(dst, a, count); break;
+            case Opcode::Log: unaryLoop<Bytes, LogOp>(dst, a, count); break;
+            case Opcode::Sin: unaryLoop<Bytes, SinOp>(dst, a, count); break;
+            case Opcode::Cos: unaryLoop<Bytes, CosOp>(dst, a, count); break;
+            case Opcode::Tanh: unaryLoop<Bytes, TanhOp>(dst, a, count); break;
+        }
+    }
+};
+
+} // namespace detail
+
+// ========================
+// 表达式图（构建器）
+// ========================
+// 节点按创建顺序编号，操作数总是先于使用它的节点创建，编号顺序就是拓扑顺序。
+// 相同的运算（同一运算、同样的操作数）只保留一个节点，公式中重复的子式只计算一次
+template<typename T>
+class ExpressionGraph {
+public:
+    static_assert(std::is_floating_point_v<T>, "运行时表达式只支持浮点类型");
+
+    // 节点句柄：只是图中的编号，可以像表达式一样用运算符组合
+    class Node {
+    public:
+        Node() = default;
+
+        size_t id() const {
+            return id_;
+        }
+
+        ExpressionGraph* graph() const {
+            return graph_;
+        }
+
+        // 运算符与数学函数，写法与表达式模板相同；与标量运算时标量成为常量节点
+        friend Node operator+(const Node& a, const Node& b) {
+            return a.make(Opcode::Add, {a, b});
+        }
+
+        friend Node operator-(const Node& a, const Node& b) {
+            return a.make(Opcode::Subtract, {a, b});
+        }
+
+        friend Node operator*(const Node& a, const Node& b) {
+            return a.make(Opcode::Multiply, {a, b});
+        }
+
+        friend Node operator/(const Node& a, const Node& b) {
+            return a.make(Opcode::Divide, {a, b});
+        }
+
+        friend Node operator+(const Node& a, T b) {
+            return a + a.scalar(b);
+        }
+
+        friend Node operator-(const Node& a, T b) {
+            return a - a.scalar(b);
+        }
+
+        friend Node operator*(const Node& a, T b) {
+            return a * a.scalar(b);
+        }
+
+        friend Node operator/(const Node& a, T b) {
+            return a / a.scalar(b);
+        }
+
+        friend Node operator+(T a, const Node& b) {
+            return b.scalar(a) + b;
+        }
+
+        friend Node operator-(T a, const Node& b) {
+            return b.scalar(a) - b;
+        }
+
+        friend Node operator*(T a, const Node& b) {
+            return b.scalar(a) * b;
+        }
+
+        friend Node operator/(T a, const Node& b) {
+            return b.scalar(a) / b;
+        }
+
+        friend Node operator<(const Node& a, const Node& b) {
+            return a.make(Opcode::Less, {a, b});
+        }
+
+        friend Node operator>(const Node& a, const Node& b) {
+            return a.make(Opcode::Greater, {a, b});
+        }
+
+        friend Node operator-(const Node& a) {
+            return a.make(Opcode::Negate, {a});
+        }
+
+        friend Node min(const Node& a, const Node& b) {
+            return a.make(Opcode::Minimum, {a, b});
+        }
+
+        friend Node max(const Node& a, const Node& b) {
+            return a.make(Opcode::Maximum, {a, b});
+        }
+
+        friend Node where(const Node& m, const Node& a, const Node& b) {
+            return m.make(Opcode::Select, {m, a, b});
+        }
+
+        friend Node abs(const Node& a) {
+            return a.make(Opcode::Abs, {a});
+        }
+
+        friend Node square(const Node& a) {
+            return a.make(Opcode::Square, {a});
+        }
+
+        friend Node sqrt(const Node& a) {
+            return a.make(Opcode::Sqrt, {a});
+        }
+
+        friend Node exp(const Node& a) {
+            return a.make(Opcode::Exp, {a});
+        }
+
+        friend Node log(const Node& a) {
+            return a.make(Opcode::Log, {a});
+        }
+
+        friend Node sin(const Node& a) {
+            return a.make(Opcode::Sin, {a});
+        }
+
+        friend Node cos(const Node& a) {
+            return a.make(Opcode::Cos, {a});
+        }
+
+        friend Node tanh(const Node& a) {
+            return a.make(Opcode::Tanh, {a});
+        }
+
+    private:
+        friend class ExpressionGraph;
+
+        Node(ExpressionGraph* graph, size_t id) : graph_(graph), id_(id) {}
+
+        Node make(Opcode op, std::initializer_list<Node> operands) const {
+            return owner().apply(op, operands);
+        }
+
+        Node scalar(T value) const {
+            return owner().constant(value);
+        }
+
+        ExpressionGraph& owner() const {
+            if (graph_ == nullptr) {
+                throw std::invalid_argument("节点不属于任何表达式图");
+            }
+            return *graph_;
+        }
+
+        ExpressionGraph* graph_ = nullptr;
+        size_t id_ = 0;
+    };
+
+    ExpressionGraph() = default;
+
+    // 图中的节点句柄指向图本身，复制后的句柄会指向原来的图
+    ExpressionGraph(const ExpressionGraph&) = delete;
+    ExpressionGraph& operator=(const ExpressionGraph&) = delete;
+
+    // 输入向量：所有输入的大小必须相同
+    Node input(const Vector<T>& vector) {
+        return input(vector.data(), vector.size());
+    }
+
+    Node input(const T* data, size_t size) {
+        if (hasInput_ && size != size_) {
+            throw std::invalid_argument("向量大小不匹配");
+        }
+        for (size_t id = 0; id < nodes_.size(); ++id) {
+            if (nodes_[id].kind == Kind::Input && nodes_[id].data == data) {
+                return Node(this, id);
+            }
+        }
+        size_ = size;
+        hasInput_ = true;
+        GraphNode node;
+        node.kind = Kind::Input;
+        node.data = data;
+        return add(node);
+    }
+
+    Node constant(T value) {
+        GraphNode node;
+        node.kind = Kind::Constant;
+        node.value = value;
+        return add(node);
+    }
+
+    // 按运算码建立节点，用于从配置中读出的公式：
+    //   g.apply(Opcode::Multiply, {x, g.constant(2.0)})
+    Node apply(Opcode op, std::initializer_list<Node> operands) {
+        if (operands.size() != opcodeArity(op)) {
+            throw std::invalid_argument("操作数个数不匹配");
+        }
+        GraphNode node;
+        node.kind = Kind::Operation;
+        node.op = op;
+        size_t k = 0;
+        for (const Node& operand : operands) {
+            requireOwned(operand);
+            node.operands[k++] = operand.id_;
+        }
+        auto key = std::make_tuple(op, node.operands[0], node.operands[1], node.operands[2]);
+        auto found = operations_.find(key);
+        if (found != operations_.end()) {
+            return Node(this, found->second);
+        }
+        Node result = add(node);
+        operations_.emplace(key, result.id_);
+        return result;
+    }
+
+    size_t nodeCount() const {
+        return nodes_.size();
+    }
+
+    // 编译以 root 为结果的表达式：只保留 root 依赖的节点，
+    // 按拓扑顺序生成指令，并为中间结果分配可复用的寄存器
+    CompiledExpression<T> compile(Node root) const;
+
+private:
+    friend class CompiledExpression<T>;
+
+    enum class Kind { Input, Constant, Operation };
+
+    struct GraphNode {
+        Kind kind = Kind::Operation;
+        Opcode op = Opcode::Add;
+        size_t operands[3] = {0, 0, 0};
+        const T* data = nullptr;
+        T value = T(0);
+    };
+
+    Node add(const GraphNode& node) {
+        nodes_.push_back(node);
+        return Node(this, nodes_.size() - 1);
+    }
+
+    void requireOwned(const Node& node) const {
+        if (node.graph_ != this || node.id_ >= nodes_.size()) {
+            throw std::invalid_argument("节点不属于这个表达式图");
+        }
+    }
+
+    std::vector<GraphNode> nodes_;
+    std::map<std::tuple<Opcode, size_t, size_t, size_t>, size_t> operations_;
+    size_t size_ = 0;
+    bool hasInput_ = false;
+};
+
+// ========================
+// 编译后的表达式
+// ========================
+// 字节码解释器。作为向量表达式赋值时按块执行（串行、并行、分块赋值都适用）。
+// 嵌在其他表达式里（r = f + b、sum(f)）时与 share() 相同：每个线程把当前位置开始的
+// 一块解释到自己的缓存中，之后的读取直接从缓存加载，缓存只在一次求值内有效
+template<typename T>
+class CompiledExpression : public VectorExpression<CompiledExpression<T>> {
+public:
+    using value_type = T;
+
+    // 每条指令一次处理的元素数：足够分摊分派开销，又让所有寄存器留在L2中
+    static constexpr size_t chunkElements = 1024;
+
+    // 操作数：输入向量、常量或寄存器
+    struct Operand {
+        enum class Kind { Input, Constant, Register } kind = Kind::Register;
+        size_t index = 0;
+    };
+
+    // dst 总是寄存器；最后一条指令的结果直接写入赋值目标
+    struct Instruction {
+        Opcode op;
+        size_t dst;
+        Operand args[3];
+    };
+
+    value_type operator[](size_t i) const {
+        if (const detail::SharedTile<T>* tile = lookup(i, 1)) {
+            return tile->data.data()[i - tile->begin];
+        }
+        // 不在求值过程中（例如逐元素打印）：只解释这一个元素，暂存区每个线程复用一份
+        thread_local AlignedBuffer<T> scratch;
+        if (scratch.size() < registers_ + constants_.size()) {
+            scratch.resizeForOverwrite(registers_ + constants_.size());
+        }
+        T result;
+        evaluateChunk(&result, i, 1, scratch.data(), 1);
+        return result;
+    }
+
+    template<size_t N>
+    ET_ALWAYS_INLINE Packet<T, N> packet(size_t i) const {
+        if (const detail::SharedTile<T>* tile = lookup(i, N)) {
+            return Packet<T, N>::load(tile->data.data() + (i - tile->begin));
+        }
+        Packet<T, N> result;
+        for (size_t k = 0; k < N; ++k) {
+            result.set(k, (*this)[i + k]);
+        }
+        return result;
+    }
+
+    template<typename U>
+    void evaluateInto(U* dst, size_t begin, size_t end) const {
+        if (begin >= end) {
+            return;
+        }
+        const size_t stride = std::min(chunkElements, end - begin);
+        AlignedBuffer<T> scratch((registers_ + constants_.size()) * stride +
+                                     (std::is_same_v<T, U> ? 0 : stride),
+                                 uninitialized);
+        fillConstants(scratch.data(), stride);
+        for (size_t i = begin; i < end; i += stride) {
+            const size_t count = std::min(stride, end - i);
+            if constexpr (std::is_same_v<T, U>) {
+                evaluateChunk(dst + i, i, count, scratch.data(), stride, false);
+            } else {
+                T* converted = scratch.data() + (registers_ + constants_.size()) * stride;
+                evaluateChunk(converted, i, count, scratch.data(), stride, false);
+                for (size_t j = 0; j < count; ++j) {
+                    dst[i + j] = static_cast<U>(converted[j]);
+                }
+            }
+        }
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    const std::vector<Instruction>& instructions() const {
+        return code_;
+    }
+
+    size_t registerCount() const {
+        return registers_;
+    }
+
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        detail::AliasKind result = detail::AliasKind::None;
+        for (const T* input : inputs_) {
+            result = detail::combineAlias(result, detail::leafAliasing(input, size_, dst));
+        }
+        return result;
+    }
+
+    template<typename F>
+    void forEachStream(F& f) const {
+        for (const T* input : inputs_) {
+            f(input, static_cast<std::ptrdiff_t>(sizeof(T)));
+        }
+    }
+
+private:
+    friend class ExpressionGraph<T>;
+
+    CompiledExpression()
+        : tiles_(std::make_shared<std::vector<detail::SharedTile<T>>>(
+              ThreadPool::instance().workerCount() + 1)) {}
+
+    // 返回覆盖 [i, i + width) 的当前线程缓存，未命中时从 i 开始解释一块；
+    // 不在求值过程中时返回空，由调用方逐元素解释
+    const detail::SharedTile<T>* lookup(size_t i, size_t width) const {
+        const detail::EvaluationState& state = detail::evaluationState();
+        const size_t index = ThreadPool::currentThreadIndex();
+        if (state.depth == 0 || index >= tiles_->size()) {
+            return nullptr;
+        }
+        detail::SharedTile<T>& tile = (*tiles_)[index];
+        if (tile.owner != &state || tile.epoch != state.epoch || i < tile.begin ||
+            i + width > tile.begin + tile.count) {
+            fill(tile, i);
+        }
+        return &tile;
+    }
+
+    // 缓存布局：先是一块结果，其后是解释用的暂存区；常量只在分配时写入一次
+    void fill(detail::SharedTile<T>& tile, size_t i) const {
+        if (tile.data.size() == 0) {
+            tile.data = AlignedBuffer<T>((1 + registers_ + constants_.size()) * chunkElements,
+                                         uninitialized);
+            fillConstants(tile.data.data() + chunkElements, chunkElements);
+        }
+        T* scratch = tile.data.data() + chunkElements;
+        const size_t count = std::min(size_ - i, chunkElements);
+        evaluateChunk(tile.data.data(), i, count, scratch, chunkElements, false);
+        // 嵌套的求值属于同一轮，求值前后的轮次相同
+        const detail::EvaluationState& state = detail::evaluationState();
+        tile.owner = &state;
+        tile.epoch = state.epoch;
+        tile.begin = i;
+        tile.count = count;
+    }
+
+    // 暂存区布局：先是各寄存器，再是各常量，每个占 stride 个元素
+    void fillConstants(T* scratch, size_t stride) const {
+        for (size_t k = 0; k < constants_.size(); ++k) {
+            std::fill_n(scratch + (registers_ + k) * stride, stride, constants_[k]);
+        }
+    }
+
+    const T* resolve(const Operand& operand, size_t i, T* scratch, size_t stride) const {
+        switch (operand.kind) {
+            case Operand::Kind::Input:
+                return inputs_[operand.index] + i;
+            case Operand::Kind::Constant:
+                return scratch + (registers_ + operand.index) * stride;
+            default:
+                return scratch + operand.index * stride;
+        }
+    }
+
+    // 计算 out[j] = f(i + j), j ∈ [0, count)
+    void evaluateChunk(T* out, size_t i, size_t count, T* scratch, size_t stride,
+                       bool constantsPending = true) const {
+        if (constantsPending) {
+            fillConstants(scratch, stride);
+        }
+        if (code_.empty()) {
+            std::copy_n(resolve(root_, i, scratch, stride), count, out);
+            return;
+        }
+        for (size_t k = 0; k < code_.size(); ++k) {
+            const Instruction& ins = code_[k];
+            T* target = k + 1 == code_.size() ? out : scratch + ins.dst * stride;
+            detail::simdDispatch<detail::InstructionKernel>(
+                ins.op, target, resolve(ins.args[0], i, scratch, stride),
+                resolve(ins.args[1], i, scratch, stride), resolve(ins.args[2], i, scratch, stride),
+                count);
+        }
+    }
+
+    std::vector<Instruction> code_;
+    std::vector<const T*> inputs_;
+    std::vector<T> constants_;
+    Operand root_;  // 没有任何运算（结果就是输入或常量）时直接复制
+    size_t registers_ = 0;
+    size_t size_ = 0;
+    std::shared_ptr<std::vector<detail::SharedTile<T>>> tiles_;
+};
+
+template<typename T>
+CompiledExpression<T> ExpressionGraph<T>::compile(Node root) const {
+    requireOwned(root);
+    using Operand = typename CompiledExpression<T>::Operand;
+    CompiledExpression<T> program;
+    program.size_ = size_;
+
+    // 标出 root 依赖的节点；编号大的节点只依赖编号小的节点，倒序扫描一遍即可
+    std::vector<bool> needed(root.id_ + 1, false);
+    needed[root.id_] = true;
+    for (size_t id = root.id_ + 1; id-- > 0;) {
+        if (needed[id] && nodes_[id].kind == Kind::Operation) {
+            for (size_t k = 0; k < opcodeArity(nodes_[id].op); ++k) {
+                needed[nodes_[id].operands[k]] = true;
+            }
+        }
+    }
+
+    // 每个运算节点最后一次被使用的位置，之后它的寄存器就可以复用
+    std::vector<size_t> lastUse(root.id_ + 1, 0);
+    for (size_t id = 0; id <= root.id_; ++id) {
+        if (needed[id] && nodes_[id].kind == Kind::Operation) {
+            for (size_t k = 0; k < opcodeArity(nodes_[id].op); ++k) {
+                lastUse[nodes_[id].operands[k]] = id;
+            }
+        }
+    }
+
+    std::vector<Operand> location(root.id_ + 1);
+    std::vector<size_t> freeRegisters;
+    for (size_t id = 0; id <= root.id_; ++id) {
+        if (!needed[id]) {
+            continue;
+        }
+        const GraphNode& node = nodes_[id];
+        if (node.kind == Kind::Input) {
+            location[id] = Operand{Operand::Kind::Input, program.inputs_.size()};
+            program.inputs_.push_back(node.data);
+            continue;
+        }
+        if (node.kind == Kind::Constant) {
+            location[id] = Operand{Operand::Kind::Constant, program.constants_.size()};
+            program.constants_.push_back(node.value);
+            continue;
+        }
+
+        typename CompiledExpression<T>::Instruction ins{node.op, 0, {}};
+        const size_t arity = opcodeArity(node.op);
+        for (size_t k = 0; k < arity; ++k) {
+            ins.args[k] = location[node.operands[k]];
+        }
+        for (size_t k = arity; k < 3; ++k) {
+            ins.args[k] = ins.args[0];
+        }
+        // 先释放最后一次在这里使用的操作数，结果可以原地写回其中一个寄存器
+        for (size_t k = 0; k < arity; ++k) {
+            const Operand& operand = location[node.operands[k]];
+            if (operand.kind == Operand::Kind::Register && lastUse[node.operands[k]] == id &&
+                std::find(freeRegisters.begin(), freeRegisters.end(), operand.index) ==
+                    freeRegisters.end()) {
+                freeRegisters.push_back(operand.index);
+            }
+        }
+        if (freeRegisters.empty()) {
+            ins.dst = program.registers_++;
+        } else {
+            ins.dst = freeRegisters.back();
+            freeRegisters.pop_back();
+        }
+        location[id] = Operand{Operand::Kind::Register, ins.dst};
+        program.code_.push_back(ins);
+    }
+    program.root_ = location[root.id_];
+    return program;
+}
+
+} // namespace ExpressionTemplates
+
+#endif // RUNTIME_EXPRESSION_HPP
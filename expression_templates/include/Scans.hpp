@@ -0,0 +1,227 @@
+// Scans.hpp
+#ifndef SCANS_HPP
+#define SCANS_HPP
+
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ExpressionTemplates.hpp"
+#include "Reductions.hpp"
+
+namespace ExpressionTemplates {
+
+// ========================
+// 前缀扫描
+// ========================
+// 扫描的第 i 个结果依赖前 i 个元素，不能像逐元素表达式那样按需求值，
+// 因此扫描函数直接返回结果向量；输入表达式仍在扫描过程中逐元素求值，不会先物化：
+//   Vector<double> cdf = inclusive_scan(p * w);
+//   Vector<double> peak = running_max(signal, parallel);
+// 浮点求和的结合顺序与逐个累加不同（寄存器内按二叉树相加，并行时按块相加），
+// 结果可能在最后几位上与顺序累加不同
+
+namespace detail {
+
+// 定长表达式的扫描结果仍是定长向量，能继续与定长向量运算
+template<typename Expr, size_t Size = ExpressionTraits<Expr>::static_size>
+struct ScanResult {
+    using type = StaticVector<expression_value_t<Expr>, Size>;
+};
+
+template<typename Expr>
+struct ScanResult<Expr, 0> {
+    using type = Vector<expression_value_t<Expr>>;
+};
+
+template<typename Expr>
+using scan_result_t = typename ScanResult<Expr>::type;
+
+// 寄存器内的包含扫描：log2(N) 步，每步把 packet 错开 1、2、4…… 个通道后与自身合并
+template<typename O, typename P, size_t... Step>
+ET_ALWAYS_INLINE P scanPacket(const P& packet, const P& identity, std::index_sequence<Step...>) {
+    P x = packet;
+    ((x = O::combine(x, x.template shiftUp<(size_t(1) << Step)>(identity))), ...);
+    return x;
+}
+
+template<size_t N>
+constexpr size_t log2Lanes() {
+    size_t steps = 0;
+    while ((size_t(1) << steps) < N) {
+        ++steps;
+    }
+    return steps;
+}
+
+// 扫描内核：计算 [begin, end) 内以 carry 开头的扫描，写入 dst，返回 carry 与所有元素合并后的值。
+// 每个packet先在寄存器内扫描，再与前面所有元素的合并值（carry）合并。
+// 两个packet的寄存器内扫描互不依赖，只有 carry 的更新形成依赖链
+template<template<typename> class Op, bool Inclusive>
+struct ScanKernel {
+    template<size_t Bytes, typename T, typename Expr>
+    static ET_ALWAYS_INLINE T run(T* dst, const Expr& expr, size_t begin, size_t end, T carry) {
+        using O = Op<T>;
+        size_t i = begin;
+        constexpr size_t N = packetLanes<Bytes, Expr>();
+        if constexpr (N > 1) {
+            using P = Packet<T, N>;
+            const P identity = P::broadcast(O::identity());
+            for (; i + N <= end; i += N) {
+                P x = expr.template packet<N>(i).template cast<T>();
+                P scanned = scanPacket<O>(x, identity, std::make_index_sequence<log2Lanes<N>()>{});
+                P local = Inclusive ? scanned : scanned.template shiftUp<1>(identity);
+                O::combine(P::broadcast(carry), local).store(dst + i);
+                carry = O::combine(carry, scanned[N - 1]);
+            }
+        }
+        for (; i < end; ++i) {
+            T x = static_cast<T>(expr[i]);
+            if constexpr (Inclusive) {
+                carry = O::combine(carry, x);
+                dst[i] = carry;
+            } else {
+                dst[i] = carry;
+                carry = O::combine(carry, x);
+            }
+        }
+        return carry;
+    }
+};
+
+// 并行扫描的第二遍：dst[i] = offset ⊕ dst[i]
+template<template<typename> class Op>
+struct ScanOffsetKernel {
+    template<size_t Bytes, typename T>
+    static ET_ALWAYS_INLINE void run(T* dst, size_t begin, size_t end, T offset) {
+        using O = Op<T>;
+        size_t i = begin;
+        if constexpr (Bytes != 0 && is_packet_type<T>) {
+            constexpr size_t N = Bytes / sizeof(T);
+            using P = Packet<T, N>;
+            const P base = P::broadcast(offset);
+            for (; i + N <= end; i += N) {
+                O::combine(base, P::load(dst + i)).store(dst + i);
+            }
+        }
+        for (; i < end; ++i) {
+            dst[i] = O::combine(offset, dst[i]);
+        }
+    }
+};
+
+template<template<typename> class Op, bool Inclusive, typename Expr>
+scan_result_t<Expr> scan(const Expr& expr) {
+    using T = expression_value_t<Expr>;
+    using Kernel = ScanKernel<Op, Inclusive>;
+    if constexpr (ExpressionTraits<Expr>::static_size != 0) {
+        scan_result_t<Expr> result;
+        Kernel::template run<0>(result.data(), expr, 0, ExpressionTraits<Expr>::static_size,
+                                Op<T>::identity());
+        return result;
+    } else {
+        Vector<T> result(expr.size(), uninitialized);
+        simdDispatch<Kernel>(result.data(), expr, size_t{0}, expr.size(), Op<T>::identity());
+        return result;
+    }
+}
+
+// 两遍分块并行扫描：
+//   第一遍各块独立扫描，输入表达式在这一遍中求值，同时得到每块所有元素的合并值；
+//   串行地对各块的合并值做排除扫描，得到每块的偏移；
+//   第二遍各块把偏移合并到自己的结果上（第一块的偏移是单位元，跳过）。
+// 输入表达式只求值一次，第二遍只读写结果向量
+template<template<typename> class Op, bool Inclusive, typename Expr>
+Vector<expression_value_t<Expr>> scanBlocked(const Expr& expr, ThreadPool& pool) {
+    using T = expression_value_t<Expr>;
+    using O = Op<T>;
+    const size_t n = expr.size();
+    const size_t chunk = parallelChunkSize<T>();
+    const size_t chunks = (n + chunk - 1) / chunk;
+    Vector<T> result(n, uninitialized);
+    T* dst = result.data();
+    std::vector<T> totals(chunks);
+    pool.run(chunks, [&](size_t c) {
+        size_t begin = c * chunk;
+        totals[c] = simdDispatch<ScanKernel<Op, Inclusive>>(dst, expr, begin,
+                                                            std::min(n, begin + chunk), O::identity());
+    });
+
+    std::vector<T> offsets(chunks);
+    T carry = O::identity();
+    for (size_t c = 0; c < chunks; ++c) {
+        offsets[c] = carry;
+        carry = O::combine(carry, totals[c]);
+    }
+
+    pool.run(chunks - 1, [&](size_t c) {
+        size_t begin = (c + 1) * chunk;
+        simdDispatch<ScanOffsetKernel<Op>>(dst, begin, std::min(n, begin + chunk), offsets[c + 1]);
+    });
+    return result;
+}
+
+// 定长表达式太短，不值得并行
+template<template<typename> class Op, bool Inclusive, typename Expr>
+scan_result_t<Expr> scan(const Expr& expr, ParallelTag) {
+    if constexpr (ExpressionTraits<Expr>::static_size != 0) {
+        return scan<Op, Inclusive>(expr);
+    } else {
+        ThreadPool& pool = ThreadPool::instance();
+        if (expr.size() < parallelThreshold() || pool.workerCount() == 0) {
+            return scan<Op, Inclusive>(expr);
+        }
+        return scanBlocked<Op, Inclusive>(expr, pool);
+    }
+}
+
+} // namespace detail
+
+// 包含扫描（前缀和）：result[i] = x[0] + … + x[i]
+template<typename Expr>
+detail::scan_result_t<Expr> inclusive_scan(const VectorExpression<Expr>& expr) {
+    return detail::scan<detail::SumOp, true>(static_cast<const Expr&>(expr));
+}
+
+template<typename Expr>
+detail::scan_result_t<Expr> inclusive_scan(const VectorExpression<Expr>& expr, ParallelTag tag) {
+    return detail::scan<detail::SumOp, true>(static_cast<const Expr&>(expr), tag);
+}
+
+// 排除扫描：result[i] = x[0] + … + x[i-1]，result[0] = 0
+template<typename Expr>
+detail::scan_result_t<Expr> exclusive_scan(const VectorExpression<Expr>& expr) {
+    return detail::scan<detail::SumOp, false>(static_cast<const Expr&>(expr));
+}
+
+template<typename Expr>
+detail::scan_result_t<Expr> exclusive_scan(const VectorExpression<Expr>& expr, ParallelTag tag) {
+    return detail::scan<detail::SumOp, false>(static_cast<const Expr&>(expr), tag);
+}
+
+// 累计最大值：result[i] = max(x[0], …, x[i])
+template<typename Expr>
+detail::scan_result_t<Expr> running_max(const VectorExpression<Expr>& expr) {
+    return detail::scan<detail::MaxOp, true>(static_cast<const Expr&>(expr));
+}
+
+template<typename Expr>
+detail::scan_result_t<Expr> running_max(const VectorExpression<Expr>& expr, ParallelTag tag) {
+    return detail::scan<detail::MaxOp, true>(static_cast<const Expr&>(expr), tag);
+}
+
+// 累计最小值：result[i] = min(x[0], …, x[i])
+template<typename Expr>
+detail::scan_result_t<Expr> running_min(const VectorExpression<Expr>& expr) {
+    return detail::scan<detail::MinOp, true>(static_cast<const Expr&>(expr));
+}
+
+template<typename Expr>
+detail::scan_result_t<Expr> running_min(const VectorExpression<Expr>& expr, ParallelTag tag) {
+    return detail::scan<detail::MinOp, true>(static_cast<const Expr&>(expr), tag);
+}
+
+} // namespace ExpressionTemplates
+
+#endif // SCANS_HPP
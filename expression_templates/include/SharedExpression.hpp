@@ -0,0 +1,150 @@
+// SharedExpression.hpp
+#ifndef SHARED_EXPRESSION_HPP
+#define SHARED_EXPRESSION_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "ExpressionTemplates.hpp"
+#include "AlignedBuffer.hpp"
+#include "ParallelEvaluation.hpp"
+
+namespace ExpressionTemplates {
+
+// ========================
+// 公共子表达式
+// ========================
+// 表达式模板按树展开，同一个子表达式出现几次就计算几次：
+//   Vector<double> r = exp(a) * sin(b) + square(exp(a) * sin(b));   // exp、sin 各算两遍
+// share() 把子表达式包成一个共享节点，它的所有副本共用同一份缓存，
+// 子表达式按块（sharedTileElements 个元素）求值到缓冲区，之后的读取直接从缓冲区加载：
+//   auto s = share(exp(a) * sin(b));
+//   Vector<double> r = s + s * s;                                  // 每个元素只算一遍
+// 缓冲区与L1同量级，读取时仍在缓存中，整个求值不会物化出完整长度的临时向量。
+// 每次读取都要检查缓存，子表达式只是 a + b 这样受内存带宽限制的运算时，重复计算反而更快；
+// 子表达式含超越函数等计算密集的运算时才值得共享（2^20 个元素的上例约快一倍）。
+//
+// 缓存只在一次求值内有效（见 SimdPacket.hpp 中的求值轮次），两次赋值之间叶子的数据
+// 可以改变；不在求值过程中的读取（例如逐元素打印）直接计算子表达式。
+// 线程池的每个线程各有一块缓冲区，并行赋值与并行归约都可以使用；
+// 但同一个共享节点不能同时在线程池以外的多个线程上求值。
+// 运行时表达式图（RuntimeExpression.hpp）构造节点时已自动合并相同的子表达式，不需要 share()
+
+template<typename Expr>
+class VectorShared;
+
+template<typename Expr>
+struct ExpressionTraits<VectorShared<Expr>> {
+    using value_type = expression_value_t<Expr>;
+    static constexpr bool vectorizable = ExpressionTraits<Expr>::vectorizable;
+    static constexpr size_t static_size = ExpressionTraits<Expr>::static_size;
+};
+
+namespace detail {
+
+// 每块缓存的元素数
+inline constexpr size_t sharedTileElements = 512;
+
+// 一个线程的缓存：[begin, begin + count) 的子表达式值，属于 owner 线程的第 epoch 轮求值。
+// 按缓存行对齐，不同线程的缓存描述不会落在同一缓存行上
+template<typename T>
+struct alignas(64) SharedTile {
+    const EvaluationState* owner = nullptr;
+    size_t epoch = 0;
+    size_t begin = 0;
+    size_t count = 0;
+    AlignedBuffer<T> data;
+};
+
+} // namespace detail
+
+template<typename Expr>
+class VectorShared : public VectorExpression<VectorShared<Expr>> {
+public:
+    using value_type = expression_value_t<VectorShared>;
+
+    explicit VectorShared(const VectorExpression<Expr>& expr)
+        : expr_(static_cast<const Expr&>(expr)),
+          tiles_(std::make_shared<std::vector<detail::SharedTile<value_type>>>(
+              ThreadPool::instance().workerCount() + 1)) {}
+
+    value_type operator[](size_t i) const {
+        if (const detail::SharedTile<value_type>* tile = lookup(i, 1)) {
+            return tile->data.data()[i - tile->begin];
+        }
+        return static_cast<value_type>(expr_[i]);
+    }
+
+    template<size_t N>
+    ET_ALWAYS_INLINE Packet<value_type, N> packet(size_t i) const {
+        if (const detail::SharedTile<value_type>* tile = lookup(i, N)) {
+            return Packet<value_type, N>::load(tile->data.data() + (i - tile->begin));
+        }
+        return expr_.template packet<N>(i).template cast<value_type>();
+    }
+
+    size_t size() const {
+        return expr_.size();
+    }
+
+    // 缓冲区会读取当前求值范围之后的元素，子表达式读取目标时不能原地逐元素求值
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return expr_.aliasing(dst) == detail::AliasKind::None ? detail::AliasKind::None
+                                                               : detail::AliasKind::Overlap;
+    }
+
+    template<typename F>
+    void forEachStream(F& f) const {
+        detail::forEachStream(expr_, f);
+    }
+
+private:
+    // 返回覆盖 [i, i + width) 的当前线程缓存，未命中时从 i 开始求值一块；
+    // 定长表达式、不在求值过程中或不在线程池线程上时返回空，由调用方直接计算
+    const detail::SharedTile<value_type>* lookup(size_t i, size_t width) const {
+        if constexpr (ExpressionTraits<Expr>::static_size != 0) {
+            return nullptr;
+        } else {
+            const detail::EvaluationState& state = detail::evaluationState();
+            const size_t index = ThreadPool::currentThreadIndex();
+            if (state.depth == 0 || index >= tiles_->size()) {
+                return nullptr;
+            }
+            detail::SharedTile<value_type>& tile = (*tiles_)[index];
+            if (tile.owner != &state || tile.epoch != state.epoch || i < tile.begin ||
+                i + width > tile.begin + tile.count) {
+                fill(tile, i);
+            }
+            return &tile;
+        }
+    }
+
+    void fill(detail::SharedTile<value_type>& tile, size_t i) const {
+        if (tile.data.size() == 0) {
+            tile.data = AlignedBuffer<value_type>(detail::sharedTileElements, uninitialized);
+        }
+        const size_t count = std::min(expr_.size() - i, detail::sharedTileElements);
+        detail::evaluateRange(tile.data.data(), detail::Shifted<Expr>(expr_, i), 0, count);
+        // 嵌套的求值属于同一轮，求值前后的轮次相同
+        const detail::EvaluationState& state = detail::evaluationState();
+        tile.owner = &state;
+        tile.epoch = state.epoch;
+        tile.begin = i;
+        tile.count = count;
+    }
+
+    detail::operand_t<Expr> expr_;
+    std::shared_ptr<std::vector<detail::SharedTile<value_type>>> tiles_;
+};
+
+// 共享子表达式：返回的节点及其副本只对子表达式求值一次
+template<typename Expr>
+VectorShared<Expr> share(const VectorExpression<Expr>& expr) {
+    return VectorShared<Expr>(expr);
+}
+
+} // namespace ExpressionTemplates
+
+#endif // SHARED_EXPRESSION_HPP
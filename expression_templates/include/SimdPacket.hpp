@@ -0,0 +1,433 @@
+// SimdPacket.hpp
+#ifndef SIMD_PACKET_HPP
+#define SIMD_PACKET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <type_traits>
+#include <utility>
+
+// GCC/Clang的向量扩展可以直接描述SSE/AVX2/AVX-512寄存器，
+// 例如 double 的 32 字节向量与 __m256d 是同一种类型
+#if defined(__GNUC__)
+#define ET_HAS_VECTOR_EXTENSIONS 1
+#define ET_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define ET_HAS_VECTOR_EXTENSIONS 0
+#define ET_ALWAYS_INLINE inline
+#endif
+
+// 只有x86上才需要（也才能）做运行时指令集分派
+#if ET_HAS_VECTOR_EXTENSIONS && (defined(__x86_64__) || defined(__i386__))
+#define ET_X86_DISPATCH 1
+#else
+#define ET_X86_DISPATCH 0
+#endif
+
+namespace ExpressionTemplates {
+
+// 表达式特性，定义见 ExpressionTemplates.hpp
+template<typename Expr>
+struct ExpressionTraits;
+
+// ========================
+// 指令集级别
+// ========================
+enum class SimdLevel {
+    Scalar,   // 逐元素求值
+    Vec128,   // SSE2（或其他平台上的128位向量）
+    Vec256,   // AVX2
+    Vec512    // AVX-512F
+};
+
+inline const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Vec128: return ET_X86_DISPATCH ? "SSE2" : "128-bit";
+        case SimdLevel::Vec256: return "AVX2";
+        case SimdLevel::Vec512: return "AVX-512";
+        default: return "Scalar";
+    }
+}
+
+namespace detail {
+
+// 检测当前CPU支持的最高级别，只在第一次调用时执行
+inline SimdLevel detectSimdLevel() {
+#if ET_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return SimdLevel::Vec512;
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::Vec256;
+    if (__builtin_cpu_supports("sse2")) return SimdLevel::Vec128;
+    return SimdLevel::Scalar;
+#elif ET_HAS_VECTOR_EXTENSIONS
+    return SimdLevel::Vec128;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+inline std::atomic<SimdLevel>& activeSimdLevel() {
+    // 条款4: 确定对象被使用前已先被初始化（函数内static对象）
+    static std::atomic<SimdLevel> level{detectSimdLevel()};
+    return level;
+}
+
+} // namespace detail
+
+// 当前使用的指令集
+inline SimdLevel simdLevel() {
+    return detail::activeSimdLevel().load(std::memory_order_relaxed);
+}
+
+// 强制使用某个指令集（用于对比测试），超出CPU能力的请求会被降级
+inline void setSimdLevel(SimdLevel level) {
+    SimdLevel supported = detail::detectSimdLevel();
+    detail::activeSimdLevel().store(level < supported ? level : supported,
+                                    std::memory_order_relaxed);
+}
+
+// ========================
+// Packet: 一个SIMD寄存器里的N个T
+// ========================
+template<typename T, size_t N>
+struct Packet;
+
+namespace detail {
+
+// 比较结果（掩码）的元素类型：与被比较的类型同宽的有符号整数，
+// 这样掩码与数据的通道一一对应，可以直接用于按通道选择
+template<typename T>
+using mask_value_t = std::conditional_t<sizeof(T) == 1, std::int8_t,
+                     std::conditional_t<sizeof(T) == 2, std::int16_t,
+                     std::conditional_t<sizeof(T) == 4, std::int32_t, std::int64_t>>>;
+
+} // namespace detail
+
+#if ET_HAS_VECTOR_EXTENSIONS
+
+template<typename T, size_t N>
+struct Packet {
+    typedef T native_type __attribute__((vector_size(N * sizeof(T))));
+
+    static constexpr size_t size = N;
+
+    native_type v;
+
+    // 非对齐加载/存储，编译为 movupd/vmovupd 一类的指令
+    static ET_ALWAYS_INLINE Packet load(const T* p) {
+        Packet r;
+        std::memcpy(&r.v, p, sizeof(r.v));
+        return r;
+    }
+
+    ET_ALWAYS_INLINE void store(T* p) const {
+        std::memcpy(p, &v, sizeof(v));
+    }
+
+    // p 必须按 min(寄存器宽度, 64) 字节对齐
+    static constexpr size_t alignment = sizeof(native_type) < 64 ? sizeof(native_type) : 64;
+
+    ET_ALWAYS_INLINE void storeAligned(T* p) const {
+        std::memcpy(__builtin_assume_aligned(p, alignment), &v, sizeof(v));
+    }
+
+    static ET_ALWAYS_INLINE Packet broadcast(T value) {
+        Packet r;
+        r.v = value - native_type{};
+        return r;
+    }
+
+    ET_ALWAYS_INLINE T operator[](size_t k) const {
+        return v[k];
+    }
+
+    ET_ALWAYS_INLINE void set(size_t k, T value) {
+        v[k] = value;
+    }
+
+    // 通道整体向高位移动 K 个位置，空出的低位通道取 fill 对应通道的值：
+    // r[k] = k < K ? fill[k] : v[k - K]，编译为 vpermt2pd/valignq 一类的指令
+    template<size_t K>
+    ET_ALWAYS_INLINE Packet shiftUp(const Packet& fill) const {
+        static_assert(K < N, "移动的通道数必须小于通道数");
+        return shiftUp<K>(fill, std::make_index_sequence<N>{});
+    }
+
+    // 逐通道类型转换（同类型时不做任何事），编译为 cvtps2pd 一类的指令
+    template<typename U>
+    ET_ALWAYS_INLINE Packet<U, N> cast() const {
+        if constexpr (std::is_same_v<U, T>) {
+            return *this;
+        } else {
+            Packet<U, N> r;
+            r.v = __builtin_convertvector(v, typename Packet<U, N>::native_type);
+            return r;
+        }
+    }
+
+    // 参数以const引用传递，避免512位向量按值传参引起的ABI差异
+    friend ET_ALWAYS_INLINE Packet operator+(const Packet& a, const Packet& b) {
+        Packet r;
+        r.v = a.v + b.v;
+        return r;
+    }
+
+    friend ET_ALWAYS_INLINE Packet operator-(const Packet& a, const Packet& b) {
+        Packet r;
+        r.v = a.v - b.v;
+        return r;
+    }
+
+    friend ET_ALWAYS_INLINE Packet operator*(const Packet& a, const Packet& b) {
+        Packet r;
+        r.v = a.v * b.v;
+        return r;
+    }
+
+    friend ET_ALWAYS_INLINE Packet operator/(const Packet& a, const Packet& b) {
+        Packet r;
+        r.v = a.v / b.v;
+        return r;
+    }
+
+    // 逐通道比较选择，编译为 minpd/maxpd 一类的指令
+    friend ET_ALWAYS_INLINE Packet min(const Packet& a, const Packet& b) {
+        Packet r;
+        r.v = a.v < b.v ? a.v : b.v;
+        return r;
+    }
+
+    friend ET_ALWAYS_INLINE Packet max(const Packet& a, const Packet& b) {
+        Packet r;
+        r.v = a.v > b.v ? a.v : b.v;
+        return r;
+    }
+
+    // 逐通道比较，结果为真的通道是1，否则是0
+    using mask_type = Packet<detail::mask_value_t<T>, N>;
+
+    friend ET_ALWAYS_INLINE mask_type operator<(const Packet& a, const Packet& b) {
+        return mask_type::fromComparison(a.v < b.v);
+    }
+
+    friend ET_ALWAYS_INLINE mask_type operator<=(const Packet& a, const Packet& b) {
+        return mask_type::fromComparison(a.v <= b.v);
+    }
+
+    friend ET_ALWAYS_INLINE mask_type operator>(const Packet& a, const Packet& b) {
+        return mask_type::fromComparison(a.v > b.v);
+    }
+
+    friend ET_ALWAYS_INLINE mask_type operator>=(const Packet& a, const Packet& b) {
+        return mask_type::fromComparison(a.v >= b.v);
+    }
+
+    friend ET_ALWAYS_INLINE mask_type operator==(const Packet& a, const Packet& b) {
+        return mask_type::fromComparison(a.v == b.v);
+    }
+
+    friend ET_ALWAYS_INLINE mask_type operator!=(const Packet& a, const Packet& b) {
+        return mask_type::fromComparison(a.v != b.v);
+    }
+
+    // 向量比较得到的是全1（-1）或全0的同宽整数，转换为1/0
+    template<typename Comparison>
+    static ET_ALWAYS_INLINE Packet fromComparison(const Comparison& mask) {
+        Packet r;
+        r.v = reinterpret_cast<const native_type&>(mask) & 1;
+        return r;
+    }
+
+    // mask 不为零的通道取 a，否则取 b，编译为 blendvpd 一类的指令
+    friend ET_ALWAYS_INLINE Packet select(const mask_type& mask, const Packet& a, const Packet& b) {
+        Packet r;
+        r.v = mask.v != 0 ? a.v : b.v;
+        return r;
+    }
+
+    // 是否有任意通道不为零
+    ET_ALWAYS_INLINE bool anyNonZero() const {
+        auto mask = v != native_type{};
+        bool result = false;
+        for (size_t k = 0; k < N; ++k) {
+            result |= mask[k] != 0;
+        }
+        return result;
+    }
+
+    // 是否所有通道都不为零
+    ET_ALWAYS_INLINE bool allNonZero() const {
+        auto mask = v != native_type{};
+        bool result = true;
+        for (size_t k = 0; k < N; ++k) {
+            result &= mask[k] != 0;
+        }
+        return result;
+    }
+
+private:
+    // 下标 0..N-1 取 fill，N..2N-1 取 v
+    template<size_t K, size_t... I>
+    ET_ALWAYS_INLINE Packet shiftUp(const Packet& fill, std::index_sequence<I...>) const {
+        Packet r;
+        r.v = __builtin_shufflevector(fill.v, v, (I < K ? I : N + I - K)...);
+        return r;
+    }
+};
+
+#endif // ET_HAS_VECTOR_EXTENSIONS
+
+namespace detail {
+
+// 能放进SIMD寄存器的标量类型
+template<typename T>
+constexpr bool is_packet_type = std::is_arithmetic_v<T> && !std::is_same_v<T, bool> &&
+                                sizeof(T) <= 8;
+
+// ========================
+// 按指令集分派的内核
+// ========================
+// Kernel 提供 template<size_t Bytes> static run(args...)，Bytes 为寄存器字节数，
+// 0 表示标量版本。每个指令集一个带target属性的入口函数，内核与整棵表达式树
+// （全部 ET_ALWAYS_INLINE）内联进来后按该指令集生成代码
+#if ET_X86_DISPATCH
+template<typename Kernel, typename... Args>
+__attribute__((target("avx512f")))
+decltype(auto) runVec512(Args&&... args) {
+    return Kernel::template run<64>(std::forward<Args>(args)...);
+}
+
+template<typename Kernel, typename... Args>
+__attribute__((target("avx2")))
+decltype(auto) runVec256(Args&&... args) {
+    return Kernel::template run<32>(std::forward<Args>(args)...);
+}
+
+template<typename Kernel, typename... Args>
+__attribute__((target("sse2")))
+decltype(auto) runVec128(Args&&... args) {
+    return Kernel::template run<16>(std::forward<Args>(args)...);
+}
+#elif ET_HAS_VECTOR_EXTENSIONS
+template<typename Kernel, typename... Args>
+decltype(auto) runVec128(Args&&... args) {
+    return Kernel::template run<16>(std::forward<Args>(args)...);
+}
+#endif
+
+template<typename Kernel, typename... Args>
+decltype(auto) runScalar(Args&&... args) {
+    return Kernel::template run<0>(std::forward<Args>(args)...);
+}
+
+// 求值轮次：每个线程上最外层的内核调用开始新的一轮，嵌套的调用（例如节点在求值中途
+// 把子表达式求值到缓冲区）属于同一轮。缓存中间结果的节点（见 share()）据此判断
+// 缓存是否仍属于当前这次求值，两次求值之间叶子的数据可能已经改变
+struct EvaluationState {
+    size_t epoch = 0;
+    size_t depth = 0;
+};
+
+inline EvaluationState& evaluationState() {
+    thread_local EvaluationState state;
+    return state;
+}
+
+class EvaluationScope {
+public:
+    EvaluationScope() {
+        EvaluationState& state = evaluationState();
+        if (state.depth++ == 0) {
+            ++state.epoch;
+        }
+    }
+
+    ~EvaluationScope() {
+        --evaluationState().depth;
+    }
+
+    EvaluationScope(const EvaluationScope&) = delete;
+    EvaluationScope& operator=(const EvaluationScope&) = delete;
+};
+
+// 按运行时检测到的指令集调用 Kernel
+template<typename Kernel, typename... Args>
+decltype(auto) simdDispatch(Args&&... args) {
+    EvaluationScope scope;
+    switch (simdLevel()) {
+#if ET_X86_DISPATCH
+        case SimdLevel::Vec512:
+            return runVec512<Kernel>(std::forward<Args>(args)...);
+        case SimdLevel::Vec256:
+            return runVec256<Kernel>(std::forward<Args>(args)...);
+#endif
+#if ET_HAS_VECTOR_EXTENSIONS
+        case SimdLevel::Vec128:
+            return runVec128<Kernel>(std::forward<Args>(args)...);
+#endif
+        default:
+            return runScalar<Kernel>(std::forward<Args>(args)...);
+    }
+}
+
+// 一个Bytes字节的寄存器能放下多少个表达式的值，0 表示该表达式只能走标量路径
+template<size_t Bytes, typename Expr>
+constexpr size_t packetLanes() {
+    using V = typename ExpressionTraits<Expr>::value_type;
+    if constexpr (Bytes == 0 || !ExpressionTraits<Expr>::vectorizable) {
+        return 0;
+    } else {
+        return Bytes / sizeof(V);
+    }
+}
+
+// 赋值内核：主循环按packet推进，剩下不足一个寄存器的元素走标量尾循环
+struct AssignKernel {
+    template<size_t Bytes, typename T, typename Expr>
+    static ET_ALWAYS_INLINE void run(T* dst, const Expr& expr, size_t begin, size_t end) {
+        size_t i = begin;
+        constexpr size_t N = packetLanes<Bytes, Expr>();
+        if constexpr (N != 0 && is_packet_type<T>) {
+            // 先用标量写到目标地址对齐，之后每次存储都落在完整的缓存行内
+            constexpr size_t align = Packet<T, N>::alignment;
+            while (i < end && reinterpret_cast<std::uintptr_t>(dst + i) % align != 0) {
+                dst[i] = expr[i];
+                ++i;
+            }
+            for (; i + N <= end; i += N) {
+                expr.template packet<N>(i).template cast<T>().storeAligned(dst + i);
+            }
+        }
+        for (; i < end; ++i) {
+            dst[i] = expr[i];
+        }
+    }
+};
+
+// 表达式可以提供 evaluateInto(dst, begin, end) 自己决定求值方式，
+// 例如稀疏与稠密混合的表达式先写入稠密部分，再只在非零位置上修正
+template<typename Expr, typename T, typename = void>
+struct has_custom_evaluation : std::false_type {};
+
+template<typename Expr, typename T>
+struct has_custom_evaluation<Expr, T, std::void_t<decltype(std::declval<const Expr&>().evaluateInto(
+                                          std::declval<T*>(), size_t{}, size_t{}))>>
+    : std::true_type {};
+
+// 计算 dst[i] = expr[i], i ∈ [begin, end)
+template<typename T, typename Expr>
+void evaluateRange(T* dst, const Expr& expr, size_t begin, size_t end) {
+    if constexpr (has_custom_evaluation<Expr, T>::value) {
+        expr.evaluateInto(dst, begin, end);
+    } else {
+        simdDispatch<AssignKernel>(dst, expr, begin, end);
+    }
+}
+
+} // namespace detail
+
+} // namespace ExpressionTemplates
+
+#endif // SIMD_PACKET_HPP
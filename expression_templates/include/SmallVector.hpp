@@ -0,0 +1,257 @@
+// SmallVector.hpp
+#ifndef SMALL_VECTOR_HPP
+#define SMALL_VECTOR_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <utility>
+
+#include "ExpressionTemplates.hpp"
+#include "AlignedBuffer.hpp"
+
+namespace ExpressionTemplates {
+
+// ========================
+// 小向量：长度不超过 InlineCapacity 时数据保存在对象内部
+// ========================
+// Vector<T> 的每次构造都要在堆上分配，只有几个元素时分配本身比求值还慢。
+// SmallVector 的长度仍在运行时决定，但不超过 InlineCapacity 时直接使用对象内的存储，
+// 超过时才与 Vector 一样分配64字节对齐的堆内存：
+//   SmallVector<double> p = a + b * 2.0;          // 默认最多16个元素不分配
+//   SmallVector<float, 64> q(n);
+// 它与 Vector 一样是表达式的叶子，可以与任何同类型的表达式混合运算。
+// 对象本身因此变大（SmallVector<double> 约200字节），按值传递或放进容器时要考虑这一点
+template<typename T, size_t InlineCapacity = 16>
+class SmallVector;
+
+template<typename T, size_t InlineCapacity>
+struct ExpressionTraits<SmallVector<T, InlineCapacity>> {
+    using value_type = T;
+    static constexpr bool vectorizable = detail::is_packet_type<T>;
+    static constexpr size_t static_size = 0;
+};
+
+namespace detail {
+
+template<typename T, size_t InlineCapacity>
+struct OperandStorage<SmallVector<T, InlineCapacity>> {
+    using type = const SmallVector<T, InlineCapacity>&;
+};
+
+// 对象内存储的对齐：不超过存储大小的最大2的幂，最多64字节（一个缓存行），
+// 这样整块存储能按寄存器宽度对齐写入，又不会为很小的存储浪费空间
+template<typename T, size_t InlineCapacity>
+constexpr size_t inlineAlignment() {
+    size_t alignment = alignof(T);
+    while (alignment < 64 && alignment * 2 <= InlineCapacity * sizeof(T)) {
+        alignment *= 2;
+    }
+    return alignment;
+}
+
+} // namespace detail
+
+template<typename T, size_t InlineCapacity>
+class SmallVector : public VectorExpression<SmallVector<T, InlineCapacity>> {
+public:
+    static_assert(InlineCapacity > 0, "对象内存储至少要能放下一个元素");
+
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    static constexpr size_t inline_capacity = InlineCapacity;
+
+    SmallVector() = default;
+
+    explicit SmallVector(size_t size) : SmallVector(size, T()) {}
+
+    SmallVector(size_t size, T value) {
+        resizeForOverwrite(size);
+        std::fill(begin(), end(), value);
+    }
+
+    // 不初始化元素的构造函数，调用者负责随后写入全部元素
+    SmallVector(size_t size, UninitializedTag) {
+        resizeForOverwrite(size);
+    }
+
+    SmallVector(std::initializer_list<T> values) {
+        resizeForOverwrite(values.size());
+        std::copy(values.begin(), values.end(), begin());
+    }
+
+    template<typename Expr>
+    SmallVector(const VectorExpression<Expr>& expr) {
+        resizeForOverwrite(expr.size());
+        detail::evaluateRange(data(), static_cast<const Expr&>(expr), 0, size_);
+    }
+
+    // 复制与移动只处理实际使用的存储：对象内的元素逐个复制，堆上的缓冲区整体移动
+    SmallVector(const SmallVector& other) {
+        resizeForOverwrite(other.size_);
+        std::copy(other.begin(), other.end(), begin());
+    }
+
+    SmallVector(SmallVector&& other) noexcept {
+        swap(other);
+    }
+
+    // 条款11: 在operator=中处理"自我赋值"（copy and swap）
+    SmallVector& operator=(SmallVector other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    // 条款25: 考虑写出一个不抛异常的swap函数
+    // 对象内的元素只交换实际使用的部分
+    void swap(SmallVector& other) noexcept {
+        const size_t mine = isInline() ? size_ : 0;
+        const size_t theirs = other.isInline() ? other.size_ : 0;
+        T temp[InlineCapacity];
+        std::move(inline_, inline_ + mine, temp);
+        std::move(other.inline_, other.inline_ + theirs, inline_);
+        std::move(temp, temp + mine, other.inline_);
+        heap_.swap(other.heap_);
+        std::swap(size_, other.size_);
+    }
+
+    // 从表达式赋值，别名处理与 Vector 相同
+    template<typename Expr>
+    SmallVector& operator=(const VectorExpression<Expr>& expr) {
+        if (needsTemporary(expr)) {
+            SmallVector temp(expr);
+            swap(temp);
+            return *this;
+        }
+        return assignDirect(expr);
+    }
+
+    template<typename Expr>
+    SmallVector& assign(const VectorExpression<Expr>& expr) {
+        return *this = expr;
+    }
+
+    // 并行或分块赋值（policy 为 parallel 或 Tiling），长度超过对象内存储时才有意义
+    template<typename Expr, typename Policy>
+    SmallVector& assign(const VectorExpression<Expr>& expr, const Policy& policy) {
+        if (needsTemporary(expr)) {
+            SmallVector temp(expr.size(), uninitialized);
+            temp.assignDirect(expr, policy);
+            swap(temp);
+            return *this;
+        }
+        return assignDirect(expr, policy);
+    }
+
+    detail::NoAlias<SmallVector> noalias() {
+        return detail::NoAlias<SmallVector>(*this);
+    }
+
+    detail::MemoryRegion region() const {
+        return detail::regionOf(data(), size_);
+    }
+
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return detail::leafAliasing(data(), size_, dst);
+    }
+
+    template<typename F>
+    void forEachStream(F& f) const {
+        f(data(), static_cast<std::ptrdiff_t>(sizeof(T)));
+    }
+
+    T& operator[](size_t i) {
+        return data()[i];
+    }
+
+    const T& operator[](size_t i) const {
+        return data()[i];
+    }
+
+    template<size_t N>
+    ET_ALWAYS_INLINE Packet<T, N> packet(size_t i) const {
+        return Packet<T, N>::load(data() + i);
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    // 数据是否保存在对象内部（没有堆分配）
+    bool isInline() const {
+        return size_ <= InlineCapacity;
+    }
+
+    // 改变大小，不保证保留任何元素的值：调用者会随即覆盖全部元素。
+    // 变回短向量时保留已分配的堆内存，之后再次变长不必重新分配
+    void resizeForOverwrite(size_t size) {
+        heap_.resizeForOverwrite(size <= InlineCapacity ? 0 : size);
+        size_ = size;
+    }
+
+    T* data() {
+        return isInline() ? inline_ : heap_.data();
+    }
+
+    const T* data() const {
+        return isInline() ? inline_ : heap_.data();
+    }
+
+    iterator begin() {
+        return data();
+    }
+
+    iterator end() {
+        return data() + size_;
+    }
+
+    const_iterator begin() const {
+        return data();
+    }
+
+    const_iterator end() const {
+        return data() + size_;
+    }
+
+private:
+    friend class detail::NoAlias<SmallVector>;
+
+    template<typename Expr>
+    bool needsTemporary(const VectorExpression<Expr>& expr) const {
+        detail::AliasKind kind = expr.aliasing(region());
+        return kind == detail::AliasKind::Overlap ||
+               (kind != detail::AliasKind::None && expr.size() != size_);
+    }
+
+    template<typename Expr>
+    SmallVector& assignDirect(const VectorExpression<Expr>& expr) {
+        resizeForOverwrite(expr.size());
+        detail::evaluateRange(data(), static_cast<const Expr&>(expr), 0, size_);
+        return *this;
+    }
+
+    template<typename Expr>
+    SmallVector& assignDirect(const VectorExpression<Expr>& expr, ParallelTag) {
+        resizeForOverwrite(expr.size());
+        detail::evaluateParallel(data(), static_cast<const Expr&>(expr), size_);
+        return *this;
+    }
+
+    template<typename Expr>
+    SmallVector& assignDirect(const VectorExpression<Expr>& expr, const Tiling& tiling) {
+        resizeForOverwrite(expr.size());
+        detail::evaluateTiled(data(), static_cast<const Expr&>(expr), size_, tiling);
+        return *this;
+    }
+
+    // 对象内的元素不做初始化，与 Vector(size, uninitialized) 一样由构造函数负责写入
+    alignas(detail::inlineAlignment<T, InlineCapacity>()) T inline_[InlineCapacity];
+    AlignedBuffer<T> heap_;
+    size_t size_ = 0;
+};
+
+} // namespace ExpressionTemplates
+
+#endif // SMALL_VECTOR_HPP
@@ -0,0 +1,682 @@
+// SparseVector.hpp
+#ifndef SPARSE_VECTOR_HPP
+#define SPARSE_VECTOR_HPP
+
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ExpressionTemplates.hpp"
+
+namespace ExpressionTemplates {
+
+// ========================
+// 稀疏向量表达式
+// ========================
+// 稀疏表达式不支持按下标随机遍历，而是提供按下标递增顺序访问非零元素的游标：
+//   auto it = expr.cursor(begin);   // 第一个下标不小于begin的非零元素
+//   it.valid() / it.index() / it.value() / it.next()
+// 运算的代价因此只与非零元素个数（nnz）有关。
+// 操作数是稀疏还是稠密在编译期就能确定，由重载决定采用哪种遍历方式：
+//   稀疏 ± 稀疏   -> 稀疏，归并两个下标集合
+//   稀疏 * 标量   -> 稀疏，下标集合不变
+//   稀疏 * 稠密   -> 稀疏，只访问稀疏一侧的非零位置
+//   稀疏 ± 稠密   -> 稠密，先写入稠密部分，再只在非零位置上修正
+//   dot(稀疏, 稠密) 的代价是 O(nnz)
+template<typename T>
+class SparseVector;
+
+template<typename LhsExpr, typename RhsExpr, bool Subtract>
+class SparseSum;
+
+template<typename Expr, typename Scalar>
+class SparseScaled;
+
+template<typename SparseExpr, typename DenseExpr>
+class SparseDenseProduct;
+
+template<typename SparseExpr, typename DenseExpr, bool NegateSparse, bool NegateDense>
+class SparseDenseSum;
+
+template<typename T>
+struct ExpressionTraits<SparseVector<T>> {
+    using value_type = T;
+    static constexpr bool vectorizable = false;
+    static constexpr size_t static_size = 0;
+};
+
+template<typename LhsExpr, typename RhsExpr, bool Subtract>
+struct ExpressionTraits<SparseSum<LhsExpr, RhsExpr, Subtract>> {
+    using value_type = detail::common_value_t<LhsExpr, RhsExpr>;
+    static constexpr bool vectorizable = false;
+    static constexpr size_t static_size = 0;
+};
+
+template<typename Expr, typename Scalar>
+struct ExpressionTraits<SparseScaled<Expr, Scalar>> {
+    using value_type = detail::scaled_value_t<expression_value_t<Expr>, Scalar>;
+    static constexpr bool vectorizable = false;
+    static constexpr size_t static_size = 0;
+};
+
+template<typename SparseExpr, typename DenseExpr>
+struct ExpressionTraits<SparseDenseProduct<SparseExpr, DenseExpr>> {
+    using value_type = detail::common_value_t<SparseExpr, DenseExpr>;
+    static constexpr bool vectorizable = false;
+    static constexpr size_t static_size = 0;
+};
+
+// 结果是稠密表达式，但只能逐元素求值（按下标查找稀疏部分），
+// 直接赋给向量时走 evaluateInto
+template<typename SparseExpr, typename DenseExpr, bool NegateSparse, bool NegateDense>
+struct ExpressionTraits<SparseDenseSum<SparseExpr, DenseExpr, NegateSparse, NegateDense>> {
+    using value_type = detail::common_value_t<SparseExpr, DenseExpr>;
+    static constexpr bool vectorizable = false;
+    static constexpr size_t static_size = 0;
+};
+
+// 稀疏表达式基类
+template<typename Derived>
+class SparseExpression {
+public:
+    using value_type = expression_value_t<Derived>;
+
+    // 第一个下标不小于begin的非零元素
+    auto cursor(size_t begin = 0) const {
+        return static_cast<const Derived&>(*this).cursor(begin);
+    }
+
+    // 按下标查找，O(log nnz)；不是非零位置时返回0
+    value_type valueAt(size_t i) const {
+        return static_cast<const Derived&>(*this).valueAt(i);
+    }
+
+    size_t size() const {
+        return static_cast<const Derived&>(*this).size();
+    }
+
+    // 非零元素个数的上界，用于预留空间
+    size_t nonZerosBound() const {
+        return static_cast<const Derived&>(*this).nonZerosBound();
+    }
+
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return static_cast<const Derived&>(*this).aliasing(dst);
+    }
+};
+
+namespace detail {
+
+template<typename T>
+struct OperandStorage<SparseVector<T>> {
+    using type = const SparseVector<T>&;
+};
+
+template<typename LhsExpr, typename RhsExpr>
+void requireSameSparseSize(const LhsExpr& lhs, const RhsExpr& rhs) {
+    if (lhs.size() != rhs.size()) {
+        throw std::invalid_argument("向量大小不匹配");
+    }
+}
+
+} // namespace detail
+
+// ========================
+// 稀疏向量：按下标递增保存非零元素的下标与值（CSR中的一行）
+// ========================
+template<typename T>
+class SparseVector : public SparseExpression<SparseVector<T>> {
+public:
+    using value_type = T;
+
+    class Cursor {
+    public:
+        Cursor(const size_t* index, const size_t* end, const T* value)
+            : index_(index), end_(end), value_(value) {}
+
+        bool valid() const {
+            return index_ != end_;
+        }
+
+        size_t index() const {
+            return *index_;
+        }
+
+        T value() const {
+            return *value_;
+        }
+
+        void next() {
+            ++index_;
+            ++value_;
+        }
+
+    private:
+        const size_t* index_;
+        const size_t* end_;
+        const T* value_;
+    };
+
+    SparseVector() = default;
+
+    // 全零的稀疏向量
+    explicit SparseVector(size_t size) : size_(size) {}
+
+    // indices 必须严格递增且都小于size
+    SparseVector(size_t size, std::vector<size_t> indices, std::vector<T> values)
+        : size_(size), indices_(std::move(indices)), values_(std::move(values)) {
+        if (indices_.size() != values_.size()) {
+            throw std::invalid_argument("下标与值的个数不一致");
+        }
+        for (size_t k = 0; k < indices_.size(); ++k) {
+            if (indices_[k] >= size_ || (k > 0 && indices_[k] <= indices_[k - 1])) {
+                throw std::invalid_argument("稀疏向量的下标必须严格递增且小于向量大小");
+            }
+        }
+    }
+
+    // 从稠密表达式中收集非零元素
+    template<typename Expr>
+    explicit SparseVector(const VectorExpression<Expr>& dense) : size_(dense.size()) {
+        for (size_t i = 0; i < size_; ++i) {
+            T value = static_cast<T>(dense[i]);
+            if (value != T{}) {
+                indices_.push_back(i);
+                values_.push_back(value);
+            }
+        }
+    }
+
+    // 从稀疏表达式求值
+    template<typename Expr>
+    SparseVector(const SparseExpression<Expr>& expr) : size_(expr.size()) {
+        collect(static_cast<const Expr&>(expr));
+    }
+
+    // 先求值到新的存储再交换，s = s + t 这类自引用表达式也安全
+    template<typename Expr>
+    SparseVector& operator=(const SparseExpression<Expr>& expr) {
+        SparseVector result(expr);
+        swap(result);
+        return *this;
+    }
+
+    // 在末尾追加一个非零元素，下标必须大于已有的所有下标
+    void append(size_t index, T value) {
+        if (index >= size_ || (!indices_.empty() && index <= indices_.back())) {
+            throw std::invalid_argument("稀疏向量的下标必须严格递增且小于向量大小");
+        }
+        indices_.push_back(index);
+        values_.push_back(value);
+    }
+
+    Cursor cursor(size_t begin = 0) const {
+        auto first = std::lower_bound(indices_.begin(), indices_.end(), begin);
+        size_t k = static_cast<size_t>(first - indices_.begin());
+        return Cursor(indices_.data() + k, indices_.data() + indices_.size(), values_.data() + k);
+    }
+
+    T valueAt(size_t i) const {
+        auto it = std::lower_bound(indices_.begin(), indices_.end(), i);
+        if (it == indices_.end() || *it != i) {
+            return T{};
+        }
+        return values_[static_cast<size_t>(it - indices_.begin())];
+    }
+
+    T operator[](size_t i) const {
+        return valueAt(i);
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    size_t nonZeros() const {
+        return indices_.size();
+    }
+
+    size_t nonZerosBound() const {
+        return indices_.size();
+    }
+
+    const std::vector<size_t>& indices() const {
+        return indices_;
+    }
+
+    const std::vector<T>& values() const {
+        return values_;
+    }
+
+    // 非零值与稠密目标不共享存储
+    detail::AliasKind aliasing(const detail::MemoryRegion&) const {
+        return detail::AliasKind::None;
+    }
+
+    // 条款25: 考虑写出一个不抛异常的swap函数
+    void swap(SparseVector& other) noexcept {
+        std::swap(size_, other.size_);
+        indices_.swap(other.indices_);
+        values_.swap(other.values_);
+    }
+
+private:
+    template<typename Expr>
+    void collect(const Expr& expr) {
+        indices_.reserve(expr.nonZerosBound());
+        values_.reserve(expr.nonZerosBound());
+        for (auto it = expr.cursor(0); it.valid(); it.next()) {
+            indices_.push_back(it.index());
+            values_.push_back(static_cast<T>(it.value()));
+        }
+    }
+
+    size_t size_ = 0;
+    std::vector<size_t> indices_;
+    std::vector<T> values_;
+};
+
+// ========================
+// 稀疏 ± 稀疏：归并两个下标集合
+// ========================
+template<typename LhsExpr, typename RhsExpr, bool Subtract>
+class SparseSum : public SparseExpression<SparseSum<LhsExpr, RhsExpr, Subtract>> {
+public:
+    using value_type = expression_value_t<SparseSum>;
+
+    template<typename LhsCursor, typename RhsCursor>
+    class Cursor {
+    public:
+        Cursor(LhsCursor lhs, RhsCursor rhs) : lhs_(lhs), rhs_(rhs) {}
+
+        bool valid() const {
+            return lhs_.valid() || rhs_.valid();
+        }
+
+        size_t index() const {
+            if (!rhs_.valid()) return lhs_.index();
+            if (!lhs_.valid()) return rhs_.index();
+            return std::min(lhs_.index(), rhs_.index());
+        }
+
+        // 只有一侧在该位置有非零元素时，另一侧按0计算
+        value_type value() const {
+            size_t i = index();
+            value_type lhs = lhs_.valid() && lhs_.index() == i
+                                 ? static_cast<value_type>(lhs_.value()) : value_type{};
+            value_type rhs = rhs_.valid() && rhs_.index() == i
+                                 ? static_cast<value_type>(rhs_.value()) : value_type{};
+            return Subtract ? lhs - rhs : lhs + rhs;
+        }
+
+        void next() {
+            size_t i = index();
+            if (lhs_.valid() && lhs_.index() == i) lhs_.next();
+            if (rhs_.valid() && rhs_.index() == i) rhs_.next();
+        }
+
+    private:
+        LhsCursor lhs_;
+        RhsCursor rhs_;
+    };
+
+    SparseSum(const SparseExpression<LhsExpr>& lhs, const SparseExpression<RhsExpr>& rhs)
+        : lhs_(static_cast<const LhsExpr&>(lhs)), rhs_(static_cast<const RhsExpr&>(rhs)) {
+        detail::requireSameSparseSize(lhs_, rhs_);
+    }
+
+    auto cursor(size_t begin = 0) const {
+        auto lhs = lhs_.cursor(begin);
+        auto rhs = rhs_.cursor(begin);
+        return Cursor<decltype(lhs), decltype(rhs)>(lhs, rhs);
+    }
+
+    value_type valueAt(size_t i) const {
+        value_type lhs = static_cast<value_type>(lhs_.valueAt(i));
+        value_type rhs = static_cast<value_type>(rhs_.valueAt(i));
+        return Subtract ? lhs - rhs : lhs + rhs;
+    }
+
+    size_t size() const {
+        return lhs_.size();
+    }
+
+    size_t nonZerosBound() const {
+        return std::min(size(), lhs_.nonZerosBound() + rhs_.nonZerosBound());
+    }
+
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return detail::combineAlias(lhs_.aliasing(dst), rhs_.aliasing(dst));
+    }
+
+private:
+    detail::operand_t<LhsExpr> lhs_;
+    detail::operand_t<RhsExpr> rhs_;
+};
+
+// ========================
+// 稀疏 * 标量：下标集合不变
+// ========================
+template<typename Expr, typename Scalar>
+class SparseScaled : public SparseExpression<SparseScaled<Expr, Scalar>> {
+public:
+    using value_type = expression_value_t<SparseScaled>;
+
+    template<typename ChildCursor>
+    class Cursor {
+    public:
+        Cursor(ChildCursor child, value_type scalar) : child_(child), scalar_(scalar) {}
+
+        bool valid() const {
+            return child_.valid();
+        }
+
+        size_t index() const {
+            return child_.index();
+        }
+
+        value_type value() const {
+            return static_cast<value_type>(child_.value()) * scalar_;
+        }
+
+        void next() {
+            child_.next();
+        }
+
+    private:
+        ChildCursor child_;
+        value_type scalar_;
+    };
+
+    SparseScaled(const SparseExpression<Expr>& expr, Scalar scalar)
+        : expr_(static_cast<const Expr&>(expr)), scalar_(static_cast<value_type>(scalar)) {}
+
+    auto cursor(size_t begin = 0) const {
+        auto child = expr_.cursor(begin);
+        return Cursor<decltype(child)>(child, scalar_);
+    }
+
+    value_type valueAt(size_t i) const {
+        return static_cast<value_type>(expr_.valueAt(i)) * scalar_;
+    }
+
+    size_t size() const {
+        return expr_.size();
+    }
+
+    size_t nonZerosBound() const {
+        return expr_.nonZerosBound();
+    }
+
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return expr_.aliasing(dst);
+    }
+
+private:
+    detail::operand_t<Expr> expr_;
+    value_type scalar_;
+};
+
+// ========================
+// 稀疏 * 稠密（逐元素）：只访问稀疏一侧的非零位置
+// ========================
+template<typename SparseExpr, typename DenseExpr>
+class SparseDenseProduct : public SparseExpression<SparseDenseProduct<SparseExpr, DenseExpr>> {
+public:
+    using value_type = expression_value_t<SparseDenseProduct>;
+
+    template<typename ChildCursor>
+    class Cursor {
+    public:
+        Cursor(ChildCursor child, const DenseExpr& dense) : child_(child), dense_(dense) {}
+
+        bool valid() const {
+            return child_.valid();
+        }
+
+        size_t index() const {
+            return child_.index();
+        }
+
+        value_type value() const {
+            return static_cast<value_type>(child_.value()) *
+                   static_cast<value_type>(dense_[child_.index()]);
+        }
+
+        void next() {
+            child_.next();
+        }
+
+    private:
+        ChildCursor child_;
+        const DenseExpr& dense_;
+    };
+
+    SparseDenseProduct(const SparseExpression<SparseExpr>& sparse,
+                       const VectorExpression<DenseExpr>& dense)
+        : sparse_(static_cast<const SparseExpr&>(sparse)),
+          dense_(static_cast<const DenseExpr&>(dense)) {
+        detail::requireSameSparseSize(sparse_, dense_);
+    }
+
+    auto cursor(size_t begin = 0) const {
+        auto child = sparse_.cursor(begin);
+        return Cursor<decltype(child)>(child, dense_);
+    }
+
+    value_type valueAt(size_t i) const {
+        return static_cast<value_type>(sparse_.valueAt(i)) * static_cast<value_type>(dense_[i]);
+    }
+
+    size_t size() const {
+        return sparse_.size();
+    }
+
+    size_t nonZerosBound() const {
+        return sparse_.nonZerosBound();
+    }
+
+    // 每个非零位置先读后写，只在同一下标处重叠是安全的
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return detail::combineAlias(sparse_.aliasing(dst), dense_.aliasing(dst));
+    }
+
+private:
+    detail::operand_t<SparseExpr> sparse_;
+    detail::operand_t<DenseExpr> dense_;
+};
+
+// ========================
+// 稀疏 ± 稠密：结果是稠密的
+// ========================
+// 结果 = (±dense) + (±sparse)。赋给向量时先用SIMD内核写入稠密部分，
+// 再只在稀疏部分的非零位置上修正，代价是 O(n) 的稠密遍历加 O(nnz)
+template<typename SparseExpr, typename DenseExpr, bool NegateSparse, bool NegateDense>
+class SparseDenseSum
+    : public VectorExpression<SparseDenseSum<SparseExpr, DenseExpr, NegateSparse, NegateDense>> {
+public:
+    using value_type = expression_value_t<SparseDenseSum>;
+
+    SparseDenseSum(const SparseExpression<SparseExpr>& sparse,
+                   const VectorExpression<DenseExpr>& dense)
+        : sparse_(static_cast<const SparseExpr&>(sparse)),
+          dense_(static_cast<const DenseExpr&>(dense)) {
+        detail::requireSameSparseSize(sparse_, dense_);
+    }
+
+    // 嵌套在更大的稠密表达式里时只能逐元素查找稀疏部分
+    value_type operator[](size_t i) const {
+        value_type dense = static_cast<value_type>(dense_[i]);
+        value_type sparse = static_cast<value_type>(sparse_.valueAt(i));
+        return (NegateDense ? value_type{} - dense : dense) +
+               (NegateSparse ? value_type{} - sparse : sparse);
+    }
+
+    template<typename T>
+    void evaluateInto(T* dst, size_t begin, size_t end) const {
+        if constexpr (NegateDense) {
+            detail::evaluateRange(dst, VectorScaled<DenseExpr, value_type>(dense_, value_type(-1)),
+                                  begin, end);
+        } else {
+            detail::evaluateRange(dst, dense_, begin, end);
+        }
+        for (auto it = sparse_.cursor(begin); it.valid() && it.index() < end; it.next()) {
+            value_type sparse = static_cast<value_type>(it.value());
+            value_type current = static_cast<value_type>(dst[it.index()]);
+            dst[it.index()] = static_cast<T>(NegateSparse ? current - sparse : current + sparse);
+        }
+    }
+
+    size_t size() const {
+        return dense_.size();
+    }
+
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return detail::combineAlias(sparse_.aliasing(dst), dense_.aliasing(dst));
+    }
+
+    // 稀疏部分的访问是跳跃的，只预取稠密部分
+    template<typename F>
+    void forEachStream(F& f) const {
+        detail::forEachStream(dense_, f);
+    }
+
+private:
+    detail::operand_t<SparseExpr> sparse_;
+    detail::operand_t<DenseExpr> dense_;
+};
+
+// ========================
+// 运算符
+// ========================
+template<typename LhsExpr, typename RhsExpr>
+SparseSum<LhsExpr, RhsExpr, false> operator+(const SparseExpression<LhsExpr>& lhs,
+                                             const SparseExpression<RhsExpr>& rhs) {
+    return SparseSum<LhsExpr, RhsExpr, false>(lhs, rhs);
+}
+
+template<typename LhsExpr, typename RhsExpr>
+SparseSum<LhsExpr, RhsExpr, true> operator-(const SparseExpression<LhsExpr>& lhs,
+                                            const SparseExpression<RhsExpr>& rhs) {
+    return SparseSum<LhsExpr, RhsExpr, true>(lhs, rhs);
+}
+
+template<typename Expr, typename Scalar,
+         typename = std::enable_if_t<std::is_arithmetic_v<Scalar>>>
+SparseScaled<Expr, Scalar> operator*(const SparseExpression<Expr>& expr, Scalar scalar) {
+    return SparseScaled<Expr, Scalar>(expr, scalar);
+}
+
+template<typename Expr, typename Scalar,
+         typename = std::enable_if_t<std::is_arithmetic_v<Scalar>>>
+SparseScaled<Expr, Scalar> operator*(Scalar scalar, const SparseExpression<Expr>& expr) {
+    return SparseScaled<Expr, Scalar>(expr, scalar);
+}
+
+template<typename SparseExpr, typename DenseExpr>
+SparseDenseProduct<SparseExpr, DenseExpr> operator*(const SparseExpression<SparseExpr>& sparse,
+                                                    const VectorExpression<DenseExpr>& dense) {
+    return SparseDenseProduct<SparseExpr, DenseExpr>(sparse, dense);
+}
+
+template<typename DenseExpr, typename SparseExpr>
+SparseDenseProduct<SparseExpr, DenseExpr> operator*(const VectorExpression<DenseExpr>& dense,
+                                                    const SparseExpression<SparseExpr>& sparse) {
+    return SparseDenseProduct<SparseExpr, DenseExpr>(sparse, dense);
+}
+
+template<typename SparseExpr, typename DenseExpr>
+SparseDenseSum<SparseExpr, DenseExpr, false, false> operator+(
+    const SparseExpression<SparseExpr>& sparse, const VectorExpression<DenseExpr>& dense) {
+    return SparseDenseSum<SparseExpr, DenseExpr, false, false>(sparse, dense);
+}
+
+template<typename DenseExpr, typename SparseExpr>
+SparseDenseSum<SparseExpr, DenseExpr, false, false> operator+(
+    const VectorExpression<DenseExpr>& dense, const SparseExpression<SparseExpr>& sparse) {
+    return SparseDenseSum<SparseExpr, DenseExpr, false, false>(sparse, dense);
+}
+
+template<typename SparseExpr, typename DenseExpr>
+SparseDenseSum<SparseExpr, DenseExpr, false, true> operator-(
+    const SparseExpression<SparseExpr>& sparse, const VectorExpression<DenseExpr>& dense) {
+    return SparseDenseSum<SparseExpr, DenseExpr, false, true>(sparse, dense);
+}
+
+template<typename DenseExpr, typename SparseExpr>
+SparseDenseSum<SparseExpr, DenseExpr, true, false> operator-(
+    const VectorExpression<DenseExpr>& dense, const SparseExpression<SparseExpr>& sparse) {
+    return SparseDenseSum<SparseExpr, DenseExpr, true, false>(sparse, dense);
+}
+
+// ========================
+// 稀疏归约
+// ========================
+
+// 所有元素之和，O(nnz)
+template<typename Expr>
+expression_value_t<Expr> sum(const SparseExpression<Expr>& expr) {
+    expression_value_t<Expr> result{};
+    for (auto it = expr.cursor(0); it.valid(); it.next()) {
+        result += it.value();
+    }
+    return result;
+}
+
+// 稀疏·稠密内积，O(nnz)
+template<typename SparseExpr, typename DenseExpr>
+detail::common_value_t<SparseExpr, DenseExpr> dot(const SparseExpression<SparseExpr>& sparse,
+                                                  const VectorExpression<DenseExpr>& dense) {
+    detail::requireSameSparseSize(sparse, dense);
+    using V = detail::common_value_t<SparseExpr, DenseExpr>;
+    V result{};
+    for (auto it = sparse.cursor(0); it.valid(); it.next()) {
+        result += static_cast<V>(it.value()) * static_cast<V>(dense[it.index()]);
+    }
+    return result;
+}
+
+template<typename DenseExpr, typename SparseExpr>
+detail::common_value_t<SparseExpr, DenseExpr> dot(const VectorExpression<DenseExpr>& dense,
+                                                  const SparseExpression<SparseExpr>& sparse) {
+    return dot(sparse, dense);
+}
+
+// 稀疏·稀疏内积：归并两个下标集合，只在两侧都非零的位置相乘，O(nnz1 + nnz2)
+template<typename LhsExpr, typename RhsExpr>
+detail::common_value_t<LhsExpr, RhsExpr> dot(const SparseExpression<LhsExpr>& lhs,
+                                             const SparseExpression<RhsExpr>& rhs) {
+    detail::requireSameSparseSize(lhs, rhs);
+    using V = detail::common_value_t<LhsExpr, RhsExpr>;
+    V result{};
+    auto l = lhs.cursor(0);
+    auto r = rhs.cursor(0);
+    while (l.valid() && r.valid()) {
+        if (l.index() < r.index()) {
+            l.next();
+        } else if (r.index() < l.index()) {
+            r.next();
+        } else {
+            result += static_cast<V>(l.value()) * static_cast<V>(r.value());
+            l.next();
+            r.next();
+        }
+    }
+    return result;
+}
+
+// 展开为稠密向量
+template<typename Expr>
+Vector<expression_value_t<Expr>> toDense(const SparseExpression<Expr>& expr) {
+    Vector<expression_value_t<Expr>> result(expr.size());
+    for (auto it = expr.cursor(0); it.valid(); it.next()) {
+        result[it.index()] = it.value();
+    }
+    return result;
+}
+
+} // namespace ExpressionTemplates
+
+#endif // SPARSE_VECTOR_HPP
@@ -0,0 +1,510 @@
+// Stencil.hpp
+#ifndef STENCIL_HPP
+#define STENCIL_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ExpressionTemplates.hpp"
+#include "AlignedBuffer.hpp"
+#include "Scans.hpp"
+#include "SharedExpression.hpp"
+
+namespace ExpressionTemplates {
+
+// ========================
+// 模板（stencil）与滑动窗口
+// ========================
+// y[i] = Σ_k w[k] * x[i + k - origin]，origin 为 0 时即 y[i] = Σ_k w[k] * x[i + k]；
+// 滑动和/均值是权重全为1（1/窗口长度）的特例，但与窗口长度无关地每个元素只需常数次运算：
+//   Vector<double> d2 = stencil(x, std::array<double, 3>{1.0, -2.0, 1.0}, boundary::clamp, 1);
+//   Vector<double> smooth = moving_mean(x, 16, boundary::wrap);
+// 权重为 std::array 时抽头数是编译期常量，内层循环完全展开；std::vector 或花括号列表在运行时给出。
+//
+// 直接赋给向量时（包括并行与分块赋值）按块求值：先把子表达式的一块（含两侧的边界）
+// 求值到L1大小的缓冲区，再在缓冲区上按packet做卷积，子表达式每个元素只求值一次。
+// 卷积嵌在更大的表达式里时逐元素按定义求值，每个元素需要 O(抽头数) 次子表达式求值；
+// 滑动和/均值嵌在更大的表达式里时与 share() 一样，每个线程把一块按上面的方式求值到
+// 自己的缓存中再按packet读取，每个元素仍只需常数次运算
+
+// 边界策略：下标 j 越界（j < 0 或 j >= n）时取什么值
+namespace boundary {
+
+// 取最近的端点元素
+struct Clamp {
+    template<typename T, typename Expr>
+    static T value(const Expr& x, std::ptrdiff_t j) {
+        return static_cast<T>(x[j < 0 ? 0 : x.size() - 1]);
+    }
+};
+
+// 取0
+struct Zero {
+    template<typename T, typename Expr>
+    static T value(const Expr&, std::ptrdiff_t) {
+        return T(0);
+    }
+};
+
+// 周期延拓，x[-1] 即 x[n - 1]
+struct Wrap {
+    template<typename T, typename Expr>
+    static T value(const Expr& x, std::ptrdiff_t j) {
+        const std::ptrdiff_t n = static_cast<std::ptrdiff_t>(x.size());
+        std::ptrdiff_t m = j % n;
+        return static_cast<T>(x[static_cast<size_t>(m < 0 ? m + n : m)]);
+    }
+};
+
+inline constexpr Clamp clamp{};
+inline constexpr Zero zero{};
+inline constexpr Wrap wrap{};
+
+} // namespace boundary
+
+template<typename Expr, typename Weights, typename Boundary>
+class VectorStencil;
+
+template<typename Expr, typename T, typename Boundary, bool Mean>
+class VectorMovingSum;
+
+template<typename Expr, typename Weights, typename Boundary>
+struct ExpressionTraits<VectorStencil<Expr, Weights, Boundary>> {
+    using value_type = typename Weights::value_type;
+    static constexpr bool vectorizable = ExpressionTraits<Expr>::vectorizable &&
+                                         detail::is_packet_type<value_type>;
+    static constexpr size_t static_size = ExpressionTraits<Expr>::static_size;
+};
+
+template<typename Expr, typename T, typename Boundary, bool Mean>
+struct ExpressionTraits<VectorMovingSum<Expr, T, Boundary, Mean>> {
+    using value_type = T;
+    static constexpr bool vectorizable = ExpressionTraits<Expr>::vectorizable &&
+                                         detail::is_packet_type<T>;
+    static constexpr size_t static_size = ExpressionTraits<Expr>::static_size;
+};
+
+namespace detail {
+
+// 每块输出的元素数，缓冲区再加上 抽头数 - 1 个边界元素
+inline constexpr size_t stencilTileElements = 2048;
+
+// x[j]，越界时按边界策略取值
+template<typename T, typename Boundary, typename Expr>
+T sampleAt(const Expr& x, std::ptrdiff_t j) {
+    if (j < 0 || j >= static_cast<std::ptrdiff_t>(x.size())) {
+        return Boundary::template value<T>(x, j);
+    }
+    return static_cast<T>(x[static_cast<size_t>(j)]);
+}
+
+// buffer[m] = x[first + m], m ∈ [0, count)：范围内的部分按子表达式自己的求值路径（packet）求值，
+// 两侧越界的部分按边界策略填充
+template<typename Boundary, typename T, typename Expr>
+void loadWindow(T* buffer, const Expr& x, std::ptrdiff_t first, size_t count) {
+    const std::ptrdiff_t n = static_cast<std::ptrdiff_t>(x.size());
+    const std::ptrdiff_t last = first + static_cast<std::ptrdiff_t>(count);
+    const std::ptrdiff_t lo = std::max<std::ptrdiff_t>(first, 0);
+    const std::ptrdiff_t hi = std::min(last, n);
+    if (lo < hi) {
+        evaluateRange(buffer + (lo - first), Shifted<Expr>(x, static_cast<size_t>(lo)), 0,
+                      static_cast<size_t>(hi - lo));
+    }
+    for (std::ptrdiff_t j = first; j < std::min(last, lo); ++j) {
+        buffer[j - first] = Boundary::template value<T>(x, j);
+    }
+    for (std::ptrdiff_t j = std::max(first, std::max(hi, lo)); j < last; ++j) {
+        buffer[j - first] = Boundary::template value<T>(x, j);
+    }
+}
+
+// 在缓冲区上做卷积：dst[j] = Σ_k w[k] * src[j + k], j ∈ [0, count)
+struct StencilTileKernel {
+    template<size_t Bytes, typename T, typename Weights>
+    static ET_ALWAYS_INLINE void run(T* dst, const T* src, size_t count, const Weights& weights) {
+        const size_t taps = weights.size();
+        size_t j = 0;
+        if constexpr (Bytes != 0 && is_packet_type<T>) {
+            constexpr size_t N = Bytes / sizeof(T);
+            using P = Packet<T, N>;
+            // 四组输出共用每个权重，四条互不依赖的累加链让乘加延迟互相重叠
+            for (; j + 4 * N <= count; j += 4 * N) {
+                P w = P::broadcast(weights[0]);
+                P acc0 = w * P::load(src + j);
+                P acc1 = w * P::load(src + j + N);
+                P acc2 = w * P::load(src + j + 2 * N);
+                P acc3 = w * P::load(src + j + 3 * N);
+                for (size_t k = 1; k < taps; ++k) {
+                    w = P::broadcast(weights[k]);
+                    acc0 = acc0 + w * P::load(src + j + k);
+                    acc1 = acc1 + w * P::load(src + j + k + N);
+                    acc2 = acc2 + w * P::load(src + j + k + 2 * N);
+                    acc3 = acc3 + w * P::load(src + j + k + 3 * N);
+                }
+                acc0.store(dst + j);
+                acc1.store(dst + j + N);
+                acc2.store(dst + j + 2 * N);
+                acc3.store(dst + j + 3 * N);
+            }
+            for (; j + N <= count; j += N) {
+                P acc = P::broadcast(weights[0]) * P::load(src + j);
+                for (size_t k = 1; k < taps; ++k) {
+                    acc = acc + P::broadcast(weights[k]) * P::load(src + j + k);
+                }
+                acc.store(dst + j);
+            }
+        }
+        for (; j < count; ++j) {
+            T acc = weights[0] * src[j];
+            for (size_t k = 1; k < taps; ++k) {
+                acc += weights[k] * src[j + k];
+            }
+            dst[j] = acc;
+        }
+    }
+};
+
+// 在缓冲区上求滑动和：dst[j] = scale * Σ_{m<window} src[j + m], j ∈ [0, count)
+// 第一个窗口直接求和，之后相邻窗口之差 d[j] = src[j + window - 1] - src[j - 1]
+// 按packet做寄存器内前缀和，每个元素的运算次数与窗口长度无关。
+// 每块都重新直接求一次窗口和，滑动更新的舍入误差不会跨块累积
+struct MovingSumTileKernel {
+    template<size_t Bytes, typename T>
+    static ET_ALWAYS_INLINE void run(T* dst, const T* src, size_t count, size_t window, T scale) {
+        T running = T(0);
+        for (size_t m = 0; m < window; ++m) {
+            running += src[m];
+        }
+        dst[0] = running * scale;
+        size_t j = 1;
+        if constexpr (Bytes != 0 && is_packet_type<T>) {
+            constexpr size_t N = Bytes / sizeof(T);
+            using P = Packet<T, N>;
+            const P zero = P::broadcast(T(0));
+            const P factor = P::broadcast(scale);
+            for (; j + N <= count; j += N) {
+                P d = P::load(src + j + window - 1) - P::load(src + j - 1);
+                P scanned = scanPacket<SumOp<T>>(d, zero, std::make_index_sequence<log2Lanes<N>()>{});
+                ((P::broadcast(running) + scanned) * factor).store(dst + j);
+                running += scanned[N - 1];
+            }
+        }
+        for (; j < count; ++j) {
+            running += src[j + window - 1] - src[j - 1];
+            dst[j] = running * scale;
+        }
+    }
+};
+
+// 求一块输出 out[j] = y[t + j], j ∈ [0, count)：把子表达式的 [t - origin, t - origin + count + taps - 1)
+// 载入 buffer（至少 count + taps - 1 个元素），再由 tile(out, buffer, count) 计算
+template<typename Boundary, typename T, typename Expr, typename Tile>
+void evaluateWindowTile(T* out, T* buffer, const Expr& x, size_t t, size_t count, size_t taps,
+                        size_t origin, Tile& tile) {
+    loadWindow<Boundary>(buffer, x,
+                         static_cast<std::ptrdiff_t>(t) - static_cast<std::ptrdiff_t>(origin),
+                         count + taps - 1);
+    tile(out, buffer, count);
+}
+
+// 按块求值窗口类节点，每块由 evaluateWindowTile 计算。目标类型与节点值类型不同时先写到临时块再转换
+template<typename T, typename Boundary, typename Expr, typename U, typename Tile>
+void evaluateWindowed(U* dst, const Expr& x, size_t begin, size_t end, size_t taps,
+                      size_t origin, size_t tileElements, Tile tile) {
+    if (begin >= end) {
+        return;
+    }
+    const size_t tileCount = std::min(tileElements, end - begin);
+    AlignedBuffer<T> buffer(tileCount + taps - 1, uninitialized);
+    AlignedBuffer<T> converted(std::is_same_v<T, U> ? 0 : tileCount, uninitialized);
+    for (size_t t = begin; t < end; t += tileElements) {
+        const size_t count = std::min(tileElements, end - t);
+        if constexpr (std::is_same_v<T, U>) {
+            evaluateWindowTile<Boundary>(dst + t, buffer.data(), x, t, count, taps, origin, tile);
+        } else {
+            evaluateWindowTile<Boundary>(converted.data(), buffer.data(), x, t, count, taps, origin,
+                                         tile);
+            for (size_t j = 0; j < count; ++j) {
+                dst[t + j] = static_cast<U>(converted.data()[j]);
+            }
+        }
+    }
+}
+
+// 读取相邻元素的节点不能就地写回：只要子表达式读取目标的内存就是错位重叠
+inline AliasKind windowAliasing(AliasKind child) {
+    return child == AliasKind::None ? AliasKind::None : AliasKind::Overlap;
+}
+
+} // namespace detail
+
+// ========================
+// 模板（卷积核）节点
+// ========================
+// Weights 为 std::array<T, K>（编译期抽头数）或 std::vector<T>（运行时抽头数）
+template<typename Expr, typename Weights, typename Boundary>
+class VectorStencil : public VectorExpression<VectorStencil<Expr, Weights, Boundary>> {
+public:
+    using value_type = expression_value_t<VectorStencil>;
+
+    VectorStencil(const VectorExpression<Expr>& expr, Weights weights, size_t origin)
+        : expr_(static_cast<const Expr&>(expr)), weights_(std::move(weights)), origin_(origin) {
+        if (weights_.size() == 0) {
+            throw std::invalid_argument("卷积核不能为空");
+        }
+        if (origin_ >= weights_.size()) {
+            throw std::invalid_argument("卷积核原点越界");
+        }
+    }
+
+    value_type operator[](size_t i) const {
+        const std::ptrdiff_t first = offset(i);
+        value_type acc = weights_[0] * sample(first);
+        for (size_t k = 1; k < weights_.size(); ++k) {
+            acc += weights_[k] * sample(first + static_cast<std::ptrdiff_t>(k));
+        }
+        return acc;
+    }
+
+    // 窗口完全在范围内时直接读取子表达式的packet，靠近两端时逐通道按边界策略取值
+    template<size_t N>
+    ET_ALWAYS_INLINE Packet<value_type, N> packet(size_t i) const {
+        using P = Packet<value_type, N>;
+        const std::ptrdiff_t first = offset(i);
+        if (first >= 0 && static_cast<size_t>(first) + weights_.size() - 1 + N <= size()) {
+            const size_t j = static_cast<size_t>(first);
+            P acc = P::broadcast(weights_[0]) * detail::packetAs<value_type, Expr, N>(expr_, j);
+            for (size_t k = 1; k < weights_.size(); ++k) {
+                acc = acc + P::broadcast(weights_[k]) *
+                                detail::packetAs<value_type, Expr, N>(expr_, j + k);
+            }
+            return acc;
+        }
+        P r;
+        for (size_t k = 0; k < N; ++k) {
+            r.set(k, (*this)[i + k]);
+        }
+        return r;
+    }
+
+    template<typename U>
+    void evaluateInto(U* dst, size_t begin, size_t end) const {
+        detail::evaluateWindowed<value_type, Boundary>(
+            dst, expr_, begin, end, weights_.size(), origin_, detail::stencilTileElements,
+            [this](value_type* out, const value_type* src, size_t count) {
+                detail::simdDispatch<detail::StencilTileKernel>(out, src, count, weights_);
+            });
+    }
+
+    size_t size() const {
+        return expr_.size();
+    }
+
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return detail::windowAliasing(expr_.aliasing(dst));
+    }
+
+    template<typename F>
+    void forEachStream(F& f) const {
+        detail::forEachStream(expr_, f);
+    }
+
+private:
+    std::ptrdiff_t offset(size_t i) const {
+        return static_cast<std::ptrdiff_t>(i) - static_cast<std::ptrdiff_t>(origin_);
+    }
+
+    value_type sample(std::ptrdiff_t j) const {
+        return detail::sampleAt<value_type, Boundary>(expr_, j);
+    }
+
+    detail::operand_t<Expr> expr_;
+    Weights weights_;
+    size_t origin_;
+};
+
+// 权重转换为结果类型：float 表达式配 double 权重仍得到 float，与 x * 2.0 一致
+template<typename Expr, typename W, size_t K, typename Boundary = boundary::Zero>
+auto stencil(const VectorExpression<Expr>& x, const std::array<W, K>& weights,
+             Boundary = Boundary{}, size_t origin = 0) {
+    static_assert(K > 0, "卷积核不能为空");
+    using T = detail::scaled_value_t<expression_value_t<Expr>, W>;
+    std::array<T, K> converted{};
+    std::copy(weights.begin(), weights.end(), converted.begin());
+    return VectorStencil<Expr, std::array<T, K>, Boundary>(x, converted, origin);
+}
+
+template<typename Expr, typename W, typename Boundary = boundary::Zero>
+auto stencil(const VectorExpression<Expr>& x, const std::vector<W>& weights,
+             Boundary = Boundary{}, size_t origin = 0) {
+    using T = detail::scaled_value_t<expression_value_t<Expr>, W>;
+    return VectorStencil<Expr, std::vector<T>, Boundary>(
+        x, std::vector<T>(weights.begin(), weights.end()), origin);
+}
+
+// stencil(x, {1.0, -2.0, 1.0}, boundary::clamp, 1)
+template<typename Expr, typename W, typename Boundary = boundary::Zero>
+auto stencil(const VectorExpression<Expr>& x, std::initializer_list<W> weights,
+             Boundary policy = Boundary{}, size_t origin = 0) {
+    return stencil(x, std::vector<W>(weights), policy, origin);
+}
+
+// ========================
+// 滑动和 / 滑动均值
+// ========================
+// y[i] = scale * Σ_{m<window} x[i + m - origin]，均值的 scale 为 1/window
+// （零边界下越界的元素按0计入，仍除以完整的窗口长度）
+template<typename Expr, typename T, typename Boundary, bool Mean>
+class VectorMovingSum : public VectorExpression<VectorMovingSum<Expr, T, Boundary, Mean>> {
+public:
+    using value_type = T;
+
+    VectorMovingSum(const VectorExpression<Expr>& expr, size_t window, size_t origin)
+        : expr_(static_cast<const Expr&>(expr)), window_(window), origin_(origin),
+          tiles_(std::make_shared<std::vector<detail::SharedTile<T>>>(
+              ThreadPool::instance().workerCount() + 1)) {
+        if (window_ == 0) {
+            throw std::invalid_argument("窗口长度必须为正");
+        }
+        if (origin_ >= window_) {
+            throw std::invalid_argument("窗口原点越界");
+        }
+    }
+
+    value_type operator[](size_t i) const {
+        if (const detail::SharedTile<T>* tile = lookup(i, 1)) {
+            return tile->data.data()[i - tile->begin];
+        }
+        // 不在求值过程中（例如逐元素打印）：按定义求和
+        const std::ptrdiff_t first = offset(i);
+        T acc = T(0);
+        for (size_t m = 0; m < window_; ++m) {
+            acc += detail::sampleAt<T, Boundary>(expr_, first + static_cast<std::ptrdiff_t>(m));
+        }
+        return acc * scale();
+    }
+
+    template<size_t N>
+    ET_ALWAYS_INLINE Packet<T, N> packet(size_t i) const {
+        if (const detail::SharedTile<T>* tile = lookup(i, N)) {
+            return Packet<T, N>::load(tile->data.data() + (i - tile->begin));
+        }
+        Packet<T, N> r;
+        for (size_t k = 0; k < N; ++k) {
+            r.set(k, (*this)[i + k]);
+        }
+        return r;
+    }
+
+    template<typename U>
+    void evaluateInto(U* dst, size_t begin, size_t end) const {
+        detail::evaluateWindowed<T, Boundary>(dst, expr_, begin, end, window_, origin_,
+                                              tileElements(), tileKernel());
+    }
+
+    size_t size() const {
+        return expr_.size();
+    }
+
+    size_t window() const {
+        return window_;
+    }
+
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return detail::windowAliasing(expr_.aliasing(dst));
+    }
+
+    template<typename F>
+    void forEachStream(F& f) const {
+        detail::forEachStream(expr_, f);
+    }
+
+private:
+    std::ptrdiff_t offset(size_t i) const {
+        return static_cast<std::ptrdiff_t>(i) - static_cast<std::ptrdiff_t>(origin_);
+    }
+
+    T scale() const {
+        return Mean ? T(1) / static_cast<T>(window_) : T(1);
+    }
+
+    // 块至少是窗口长度的几倍，每块开头直接求和的开销分摊到每个元素上仍是常数
+    size_t tileElements() const {
+        return std::max(detail::stencilTileElements, 4 * window_);
+    }
+
+    auto tileKernel() const {
+        return [this](T* out, const T* src, size_t count) {
+            detail::simdDispatch<detail::MovingSumTileKernel>(out, src, count, window_, scale());
+        };
+    }
+
+    // 返回覆盖 [i, i + width) 的当前线程缓存，未命中时从 i 开始求值一块；
+    // 定长表达式或不在求值过程中时返回空，由调用方按定义求和（与 VectorShared 相同）
+    const detail::SharedTile<T>* lookup(size_t i, size_t width) const {
+        if constexpr (ExpressionTraits<Expr>::static_size != 0) {
+            return nullptr;
+        } else {
+            const detail::EvaluationState& state = detail::evaluationState();
+            const size_t index = ThreadPool::currentThreadIndex();
+            if (state.depth == 0 || index >= tiles_->size()) {
+                return nullptr;
+            }
+            detail::SharedTile<T>& tile = (*tiles_)[index];
+            if (tile.owner != &state || tile.epoch != state.epoch || i < tile.begin ||
+                i + width > tile.begin + tile.count) {
+                fill(tile, i);
+            }
+            return &tile;
+        }
+    }
+
+    // 缓存布局：先是一块输出，其后是这一块的窗口缓冲区
+    void fill(detail::SharedTile<T>& tile, size_t i) const {
+        const size_t capacity = tileElements();
+        if (tile.data.size() == 0) {
+            tile.data = AlignedBuffer<T>(2 * capacity + window_ - 1, uninitialized);
+        }
+        const size_t count = std::min(size() - i, capacity);
+        auto kernel = tileKernel();
+        detail::evaluateWindowTile<Boundary>(tile.data.data(), tile.data.data() + capacity, expr_,
+                                             i, count, window_, origin_, kernel);
+        // 嵌套的求值属于同一轮，求值前后的轮次相同
+        const detail::EvaluationState& state = detail::evaluationState();
+        tile.owner = &state;
+        tile.epoch = state.epoch;
+        tile.begin = i;
+        tile.count = count;
+    }
+
+    detail::operand_t<Expr> expr_;
+    size_t window_;
+    size_t origin_;
+    std::shared_ptr<std::vector<detail::SharedTile<T>>> tiles_;
+};
+
+// 滑动和保持表达式自身的类型
+template<typename Expr, typename Boundary = boundary::Zero>
+auto moving_sum(const VectorExpression<Expr>& x, size_t window, Boundary = Boundary{},
+                size_t origin = 0) {
+    return VectorMovingSum<Expr, expression_value_t<Expr>, Boundary, false>(x, window, origin);
+}
+
+// 滑动均值：浮点表达式保持自身精度，整数表达式得到double
+template<typename Expr, typename Boundary = boundary::Zero>
+auto moving_mean(const VectorExpression<Expr>& x, size_t window, Boundary = Boundary{},
+                 size_t origin = 0) {
+    using T = detail::scaled_value_t<expression_value_t<Expr>, double>;
+    return VectorMovingSum<Expr, T, Boundary, true>(x, window, origin);
+}
+
+} // namespace ExpressionTemplates
+
+#endif // STENCIL_HPP
@@ -0,0 +1,1001 @@
+// Tensor.hpp
+#ifndef TENSOR_HPP
+#define TENSOR_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "ExpressionTemplates.hpp"
+#include "ElementwiseOps.hpp"
+#include "Reductions.hpp"
+
+namespace ExpressionTemplates {
+
+// ========================
+// N维张量
+// ========================
+// Tensor<T, Rank> 按行主序连续存储，最后一维相邻元素相距1，第d维相距 strides()[d] 个元素。
+// 逐元素运算按NumPy的规则广播：两个形状从最后一维开始对齐，
+// 每一维的长度必须相等或其中一个为1，维数少的一方在前面补长度为1的维：
+//   Tensor<double, 2> x({rows, cols});
+//   Tensor<double, 1> bias({cols});
+//   Tensor<double, 2> column({rows, 1});
+//   Tensor<double, 2> y = (x - column) * 2.0 + bias;    // bias 广播到每一行，column 广播到每一列
+//   Tensor<double, 1> total = sum(y, 0);                 // 沿第0维归约
+// 广播不复制数据：长度为1的维在读取时步长按0处理。
+//
+// 求值按行进行：前 Rank-1 维的每个下标确定一行，每一行是一个普通的向量表达式
+// （Tensor的行、VectorSum、VectorUnaryOp……），由向量的SIMD内核沿最内层连续维求值；
+// 并行赋值把行分给线程池，行数少于线程数时再把每行切成列块。
+// 整个表达式没有广播时直接把张量当作一个长向量求值
+
+template<size_t Rank>
+using Shape = std::array<size_t, Rank>;
+
+template<typename T, size_t Rank>
+class Tensor;
+
+template<typename LhsExpr, typename RhsExpr, typename Rows>
+class TensorBinaryOp;
+
+template<typename Expr, typename Op>
+class TensorUnaryOp;
+
+template<typename Expr, typename Scalar>
+class TensorScaled;
+
+namespace detail {
+
+// Tensor的一行：从data开始的size个元素，步长为1；步长为0时每个元素都是data[0]（最后一维被广播）
+template<typename T>
+class TensorRow;
+
+// 张量表达式的行类型与维数
+template<typename Expr>
+using tensor_row_t = typename ExpressionTraits<Expr>::row_type;
+
+template<typename Expr>
+inline constexpr size_t tensor_rank_v = ExpressionTraits<Expr>::rank;
+
+// 行的构造方式：张量节点的一行由子节点的行组合而成
+struct SumRows {
+    template<typename LhsRow, typename RhsRow>
+    static VectorSum<LhsRow, RhsRow> apply(const LhsRow& lhs, const RhsRow& rhs) {
+        return VectorSum<LhsRow, RhsRow>(lhs, rhs);
+    }
+};
+
+struct DifferenceRows {
+    template<typename LhsRow, typename RhsRow>
+    static VectorDifference<LhsRow, RhsRow> apply(const LhsRow& lhs, const RhsRow& rhs) {
+        return VectorDifference<LhsRow, RhsRow>(lhs, rhs);
+    }
+};
+
+// 乘、除、min、max 直接复用 ElementwiseOps.hpp 中的运算
+template<typename Op>
+struct BinaryRows {
+    template<typename LhsRow, typename RhsRow>
+    static VectorBinaryOp<LhsRow, RhsRow, Op> apply(const LhsRow& lhs, const RhsRow& rhs) {
+        return VectorBinaryOp<LhsRow, RhsRow, Op>(lhs, rhs);
+    }
+};
+
+} // namespace detail
+
+template<typename T>
+struct ExpressionTraits<detail::TensorRow<T>> {
+    using value_type = T;
+    static constexpr bool vectorizable = detail::is_packet_type<T>;
+    static constexpr size_t static_size = 0;
+};
+
+template<typename T, size_t Rank>
+struct ExpressionTraits<Tensor<T, Rank>> {
+    using value_type = T;
+    using row_type = detail::TensorRow<T>;
+    static constexpr bool vectorizable = detail::is_packet_type<T>;
+    static constexpr size_t static_size = 0;
+    static constexpr size_t rank = Rank;
+};
+
+template<typename LhsExpr, typename RhsExpr, typename Rows>
+struct ExpressionTraits<TensorBinaryOp<LhsExpr, RhsExpr, Rows>> {
+    using row_type = decltype(Rows::apply(std::declval<const detail::tensor_row_t<LhsExpr>&>(),
+                                          std::declval<const detail::tensor_row_t<RhsExpr>&>()));
+    using value_type = expression_value_t<row_type>;
+    static constexpr bool vectorizable = ExpressionTraits<row_type>::vectorizable;
+    static constexpr size_t static_size = 0;
+    static constexpr size_t rank = std::max(detail::tensor_rank_v<LhsExpr>,
+                                            detail::tensor_rank_v<RhsExpr>);
+};
+
+template<typename Expr, typename Op>
+struct ExpressionTraits<TensorUnaryOp<Expr, Op>> {
+    using row_type = VectorUnaryOp<detail::tensor_row_t<Expr>, Op>;
+    using value_type = expression_value_t<row_type>;
+    static constexpr bool vectorizable = ExpressionTraits<row_type>::vectorizable;
+    static constexpr size_t static_size = 0;
+    static constexpr size_t rank = detail::tensor_rank_v<Expr>;
+};
+
+template<typename Expr, typename Scalar>
+struct ExpressionTraits<TensorScaled<Expr, Scalar>> {
+    using row_type = VectorScaled<detail::tensor_row_t<Expr>, Scalar>;
+    using value_type = expression_value_t<row_type>;
+    static constexpr bool vectorizable = ExpressionTraits<row_type>::vectorizable;
+    static constexpr size_t static_size = 0;
+    static constexpr size_t rank = detail::tensor_rank_v<Expr>;
+};
+
+namespace detail {
+
+template<typename T, size_t Rank>
+struct OperandStorage<Tensor<T, Rank>> {
+    using type = const Tensor<T, Rank>&;
+};
+
+template<typename T>
+class TensorRow : public VectorExpression<TensorRow<T>> {
+public:
+    using value_type = T;
+
+    TensorRow(const T* data, size_t size, bool broadcast)
+        : data_(data), size_(size), broadcast_(broadcast) {}
+
+    T operator[](size_t i) const {
+        return broadcast_ ? data_[0] : data_[i];
+    }
+
+    // 分支只取决于这一行，在整行的循环中总是走同一边
+    template<size_t N>
+    ET_ALWAYS_INLINE Packet<T, N> packet(size_t i) const {
+        if (broadcast_) {
+            return Packet<T, N>::broadcast(data_[0]);
+        }
+        return Packet<T, N>::load(data_ + i);
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    AliasKind aliasing(const MemoryRegion& dst) const {
+        return leafAliasing(data_, broadcast_ ? std::min<size_t>(size_, 1) : size_, dst);
+    }
+
+    template<typename F>
+    void forEachStream(F& f) const {
+        f(data_, broadcast_ ? std::ptrdiff_t(0) : static_cast<std::ptrdiff_t>(sizeof(T)));
+    }
+
+private:
+    const T* data_;
+    size_t size_;
+    bool broadcast_;
+};
+
+// NumPy广播规则：从最后一维开始对齐，长度相等或其中一个为1
+template<size_t Rank, size_t LhsRank, size_t RhsRank>
+Shape<Rank> broadcastShapes(const Shape<LhsRank>& lhs, const Shape<RhsRank>& rhs) {
+    Shape<Rank> result{};
+    for (size_t d = 0; d < Rank; ++d) {
+        const size_t a = d + LhsRank >= Rank ? lhs[d + LhsRank - Rank] : 1;
+        const size_t b = d + RhsRank >= Rank ? rhs[d + RhsRank - Rank] : 1;
+        if (a != b && a != 1 && b != 1) {
+            throw std::invalid_argument("张量形状不能广播");
+        }
+        result[d] = a == 1 ? b : a;
+    }
+    return result;
+}
+
+template<size_t LhsRank, size_t RhsRank>
+bool sameShape(const Shape<LhsRank>& lhs, const Shape<RhsRank>& rhs) {
+    if constexpr (LhsRank != RhsRank) {
+        return false;
+    } else {
+        return lhs == rhs;
+    }
+}
+
+template<size_t Rank>
+size_t elementCount(const Shape<Rank>& shape) {
+    size_t count = 1;
+    for (size_t extent : shape) {
+        count *= extent;
+    }
+    return count;
+}
+
+// 第 r 行（前 Rank-1 维按行主序编号）的下标，最后一维的下标为0
+template<size_t Rank>
+Shape<Rank> rowIndex(size_t r, const Shape<Rank>& shape) {
+    Shape<Rank> index{};
+    for (size_t d = Rank - 1; d-- > 0;) {
+        index[d] = r % shape[d];
+        r /= shape[d];
+    }
+    return index;
+}
+
+// 前进到下一行
+template<size_t Rank>
+void nextRow(Shape<Rank>& index, const Shape<Rank>& shape) {
+    for (size_t d = Rank - 1; d-- > 0;) {
+        if (++index[d] < shape[d]) {
+            return;
+        }
+        index[d] = 0;
+    }
+}
+
+// 行数少于线程数时每行切成的列块长度：让块数不少于线程数，块长按缓存行取整
+template<typename T>
+size_t columnBlockSize(size_t rows, size_t length, size_t threads) {
+    constexpr size_t line = 64 / sizeof(T) > 0 ? 64 / sizeof(T) : 1;
+    const size_t blocksPerRow = (threads + rows - 1) / rows;
+    const size_t block = (length + blocksPerRow - 1) / blocksPerRow;
+    return std::max(line, (block + line - 1) / line * line);
+}
+
+// 按行求值 [firstRow, lastRow)：每一行是一个向量表达式，交给向量的SIMD赋值内核
+template<typename T, typename Expr, size_t Rank>
+void evaluateTensorRows(T* dst, const Expr& expr, const Shape<Rank>& shape,
+                        size_t firstRow, size_t lastRow) {
+    const size_t inner = shape[Rank - 1];
+    Shape<Rank> index = rowIndex(firstRow, shape);
+    for (size_t r = firstRow; r < lastRow; ++r) {
+        evaluateRange(dst + r * inner, expr.row(index, inner), 0, inner);
+        nextRow(index, shape);
+    }
+}
+
+// 没有广播时整个张量是一个连续的向量表达式；否则按行求值，并行时每块是若干整行
+template<typename T, typename Expr, size_t Rank>
+void evaluateTensor(T* dst, const Expr& expr, const Shape<Rank>& shape, bool parallelize) {
+    const size_t n = elementCount(shape);
+    if (n == 0) {
+        return;
+    }
+    if (expr.flattenable()) {
+        if (parallelize) {
+            evaluateParallel(dst, expr.flatRow(), n);
+        } else {
+            evaluateRange(dst, expr.flatRow(), 0, n);
+        }
+        return;
+    }
+    const size_t inner = shape[Rank - 1];
+    const size_t rows = n / inner;
+    ThreadPool& pool = ThreadPool::instance();
+    const size_t threads = pool.workerCount() + 1;
+    if (!parallelize || n < parallelThreshold() || threads == 1) {
+        evaluateTensorRows(dst, expr, shape, 0, rows);
+        return;
+    }
+    if (rows < threads) {
+        // 行数少于线程数（例如只有一行被广播的长行）：把每行切成列块
+        const size_t block = columnBlockSize<T>(rows, inner, threads);
+        const size_t blocksPerRow = (inner + block - 1) / block;
+        pool.run(rows * blocksPerRow, [&](size_t c) {
+            const size_t r = c / blocksPerRow;
+            const size_t begin = c % blocksPerRow * block;
+            evaluateRange(dst + r * inner, expr.row(rowIndex(r, shape), inner), begin,
+                          std::min(inner, begin + block));
+        });
+        return;
+    }
+    const size_t rowsPerChunk = std::max<size_t>(1, parallelChunkSize<T>() / inner);
+    const size_t chunks = (rows + rowsPerChunk - 1) / rowsPerChunk;
+    pool.run(chunks, [&](size_t c) {
+        const size_t first = c * rowsPerChunk;
+        evaluateTensorRows(dst, expr, shape, first, std::min(rows, first + rowsPerChunk));
+    });
+}
+
+} // namespace detail
+
+// ========================
+// 张量表达式基类
+// ========================
+// 派生类提供：
+//   shape()                 广播后的形状
+//   row(index, length)      前几维下标为 index 的一行（长度为 length 的向量表达式），
+//                           index 的维数可以多于本表达式，多出的前几维被忽略
+//   flattenable()/flatRow() 没有广播时，把整个表达式当作一个长向量
+//   aliasing(dst)           与赋值目标的重叠关系
+template<typename Derived>
+class TensorExpression {
+public:
+    using value_type = expression_value_t<Derived>;
+
+    static constexpr size_t rank = detail::tensor_rank_v<Derived>;
+
+    Shape<rank> shape() const {
+        return static_cast<const Derived&>(*this).shape();
+    }
+
+    // 元素总数
+    size_t size() const {
+        return detail::elementCount(shape());
+    }
+
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return static_cast<const Derived&>(*this).aliasing(dst);
+    }
+};
+
+// ========================
+// 张量类，按行主序连续存储
+// ========================
+template<typename T, size_t Rank>
+class Tensor : public TensorExpression<Tensor<T, Rank>> {
+public:
+    static_assert(Rank >= 1, "张量至少有一维");
+
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    Tensor() : shape_{}, strides_{} {}
+
+    explicit Tensor(const Shape<Rank>& shape)
+        : shape_(shape), strides_(stridesOf(shape)), data_(detail::elementCount(shape)) {}
+
+    Tensor(const Shape<Rank>& shape, T value)
+        : shape_(shape), strides_(stridesOf(shape)), data_(detail::elementCount(shape), value) {}
+
+    Tensor(const Shape<Rank>& shape, UninitializedTag)
+        : shape_(shape), strides_(stridesOf(shape)),
+          data_(detail::elementCount(shape), uninitialized) {}
+
+    // 按行主序给出全部元素：Tensor<double, 2> m({2, 3}, {1, 2, 3, 4, 5, 6});
+    Tensor(const Shape<Rank>& shape, std::initializer_list<T> values)
+        : Tensor(shape, uninitialized) {
+        if (values.size() != data_.size()) {
+            throw std::invalid_argument("初始值个数与张量大小不符");
+        }
+        std::copy(values.begin(), values.end(), data_.begin());
+    }
+
+    template<typename Expr>
+    Tensor(const TensorExpression<Expr>& expr) : Tensor(expr.shape(), uninitialized) {
+        requireRank<Expr>();
+        detail::evaluateTensor(data_.data(), static_cast<const Expr&>(expr), shape_, false);
+    }
+
+    // 从表达式赋值，广播读取目标自身时（t = t + column）先求值到临时张量
+    template<typename Expr>
+    Tensor& operator=(const TensorExpression<Expr>& expr) {
+        if (needsTemporary(expr)) {
+            Tensor temp(expr);
+            swap(temp);
+            return *this;
+        }
+        return assignDirect(expr, false);
+    }
+
+    template<typename Expr>
+    Tensor& assign(const TensorExpression<Expr>& expr) {
+        return *this = expr;
+    }
+
+    // 并行赋值：外层各维的行分给线程池，每行仍沿最内层维按SIMD求值
+    template<typename Expr>
+    Tensor& assign(const TensorExpression<Expr>& expr, ParallelTag) {
+        if (needsTemporary(expr)) {
+            Tensor temp(expr.shape(), uninitialized);
+            temp.assignDirect(expr, true);
+            swap(temp);
+            return *this;
+        }
+        return assignDirect(expr, true);
+    }
+
+    // 条款25: 考虑写出一个不抛异常的swap函数
+    void swap(Tensor& other) noexcept {
+        std::swap(shape_, other.shape_);
+        std::swap(strides_, other.strides_);
+        data_.swap(other.data_);
+    }
+
+    template<typename... Indices>
+    T& operator()(Indices... indices) {
+        return data_[offsetOf(indices...)];
+    }
+
+    template<typename... Indices>
+    const T& operator()(Indices... indices) const {
+        return data_[offsetOf(indices...)];
+    }
+
+    T& at(const Shape<Rank>& index) {
+        return data_[offsetOf(index)];
+    }
+
+    const T& at(const Shape<Rank>& index) const {
+        return data_[offsetOf(index)];
+    }
+
+    const Shape<Rank>& shape() const {
+        return shape_;
+    }
+
+    size_t extent(size_t d) const {
+        return shape_[d];
+    }
+
+    // 各维相邻元素相距的元素数
+    const Shape<Rank>& strides() const {
+        return strides_;
+    }
+
+    size_t size() const {
+        return data_.size();
+    }
+
+    T* data() {
+        return data_.data();
+    }
+
+    const T* data() const {
+        return data_.data();
+    }
+
+    iterator begin() {
+        return data_.begin();
+    }
+
+    iterator end() {
+        return data_.end();
+    }
+
+    const_iterator begin() const {
+        return data_.begin();
+    }
+
+    const_iterator end() const {
+        return data_.end();
+    }
+
+    // 长度为1的维被广播：下标按0处理；最后一维长度为1时整行都是同一个元素
+    template<size_t R>
+    detail::TensorRow<T> row(const Shape<R>& index, size_t length) const {
+        static_assert(R >= Rank, "行下标的维数少于张量的维数");
+        size_t offset = 0;
+        for (size_t d = 0; d + 1 < Rank; ++d) {
+            if (shape_[d] != 1) {
+                offset += index[d + R - Rank] * strides_[d];
+            }
+        }
+        return detail::TensorRow<T>(data_.data() + offset, length, shape_[Rank - 1] == 1);
+    }
+
+    bool flattenable() const {
+        return true;
+    }
+
+    detail::TensorRow<T> flatRow() const {
+        return detail::TensorRow<T>(data_.data(), data_.size(), false);
+    }
+
+    detail::MemoryRegion region() const {
+        return detail::regionOf(data_.data(), data_.size());
+    }
+
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return detail::leafAliasing(data_.data(), data_.size(), dst);
+    }
+
+private:
+    static Shape<Rank> stridesOf(const Shape<Rank>& shape) {
+        Shape<Rank> strides{};
+        size_t stride = 1;
+        for (size_t d = Rank; d-- > 0;) {
+            strides[d] = stride;
+            stride *= shape[d];
+        }
+        return strides;
+    }
+
+    template<typename... Indices>
+    size_t offsetOf(Indices... indices) const {
+        static_assert(sizeof...(Indices) == Rank, "下标个数与张量的维数不同");
+        return offsetOf(Shape<Rank>{static_cast<size_t>(indices)...});
+    }
+
+    size_t offsetOf(const Shape<Rank>& index) const {
+        size_t offset = 0;
+        for (size_t d = 0; d < Rank; ++d) {
+            offset += index[d] * strides_[d];
+        }
+        return offset;
+    }
+
+    template<typename Expr>
+    static constexpr void requireRank() {
+        static_assert(detail::tensor_rank_v<Expr> == Rank, "表达式与张量的维数不同");
+    }
+
+    // 形状改变或表达式广播读取目标时，任何重叠都需要临时张量
+    template<typename Expr>
+    bool needsTemporary(const TensorExpression<Expr>& expr) const {
+        detail::AliasKind kind = expr.aliasing(region());
+        return kind == detail::AliasKind::Overlap ||
+               (kind != detail::AliasKind::None && !detail::sameShape(expr.shape(), shape_));
+    }
+
+    template<typename Expr>
+    Tensor& assignDirect(const TensorExpression<Expr>& expr, bool parallelize) {
+        requireRank<Expr>();
+        const Shape<Rank> shape = expr.shape();
+        if (shape != shape_) {
+            shape_ = shape;
+            strides_ = stridesOf(shape);
+        }
+        data_.resizeForOverwrite(detail::elementCount(shape_));
+        detail::evaluateTensor(data_.data(), static_cast<const Expr&>(expr), shape_, parallelize);
+        return *this;
+    }
+
+    Shape<Rank> shape_;
+    Shape<Rank> strides_;
+    AlignedBuffer<T> data_;
+};
+
+// ========================
+// 逐元素张量运算（带广播）
+// ========================
+template<typename LhsExpr, typename RhsExpr, typename Rows>
+class TensorBinaryOp : public TensorExpression<TensorBinaryOp<LhsExpr, RhsExpr, Rows>> {
+public:
+    using value_type = expression_value_t<TensorBinaryOp>;
+    using row_type = detail::tensor_row_t<TensorBinaryOp>;
+
+    static constexpr size_t rank = detail::tensor_rank_v<TensorBinaryOp>;
+
+    TensorBinaryOp(const TensorExpression<LhsExpr>& lhs, const TensorExpression<RhsExpr>& rhs)
+        : lhs_(static_cast<const LhsExpr&>(lhs)), rhs_(static_cast<const RhsExpr&>(rhs)),
+          shape_(detail::broadcastShapes<rank>(lhs_.shape(), rhs_.shape())) {}
+
+    Shape<rank> shape() const {
+        return shape_;
+    }
+
+    template<size_t R>
+    row_type row(const Shape<R>& index, size_t length) const {
+        return Rows::apply(lhs_.row(index, length), rhs_.row(index, length));
+    }
+
+    bool flattenable() const {
+        return detail::sameShape(lhs_.shape(), shape_) && detail::sameShape(rhs_.shape(), shape_) &&
+               lhs_.flattenable() && rhs_.flattenable();
+    }
+
+    row_type flatRow() const {
+        return Rows::apply(lhs_.flatRow(), rhs_.flatRow());
+    }
+
+    // 被广播的操作数在不同下标处读取同一个元素，与目标重叠时不是逐元素重叠
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return detail::combineAlias(operandAliasing(lhs_, dst), operandAliasing(rhs_, dst));
+    }
+
+private:
+    template<typename Expr>
+    detail::AliasKind operandAliasing(const Expr& expr, const detail::MemoryRegion& dst) const {
+        detail::AliasKind kind = expr.aliasing(dst);
+        if (kind == detail::AliasKind::Elementwise && !detail::sameShape(expr.shape(), shape_)) {
+            return detail::AliasKind::Overlap;
+        }
+        return kind;
+    }
+
+    detail::operand_t<LhsExpr> lhs_;
+    detail::operand_t<RhsExpr> rhs_;
+    Shape<rank> shape_;
+};
+
+template<typename Expr, typename Op>
+class TensorUnaryOp : public TensorExpression<TensorUnaryOp<Expr, Op>> {
+public:
+    using value_type = expression_value_t<TensorUnaryOp>;
+    using row_type = detail::tensor_row_t<TensorUnaryOp>;
+
+    static constexpr size_t rank = detail::tensor_rank_v<Expr>;
+
+    explicit TensorUnaryOp(const TensorExpression<Expr>& expr)
+        : expr_(static_cast<const Expr&>(expr)) {}
+
+    Shape<rank> shape() const {
+        return expr_.shape();
+    }
+
+    template<size_t R>
+    row_type row(const Shape<R>& index, size_t length) const {
+        return row_type(expr_.row(index, length));
+    }
+
+    bool flattenable() const {
+        return expr_.flattenable();
+    }
+
+    row_type flatRow() const {
+        return row_type(expr_.flatRow());
+    }
+
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return expr_.aliasing(dst);
+    }
+
+private:
+    detail::operand_t<Expr> expr_;
+};
+
+template<typename Expr, typename Scalar>
+class TensorScaled : public TensorExpression<TensorScaled<Expr, Scalar>> {
+public:
+    using value_type = expression_value_t<TensorScaled>;
+    using row_type = detail::tensor_row_t<TensorScaled>;
+
+    static constexpr size_t rank = detail::tensor_rank_v<Expr>;
+
+    TensorScaled(const TensorExpression<Expr>& expr, Scalar scalar)
+        : expr_(static_cast<const Expr&>(expr)), scalar_(scalar) {}
+
+    Shape<rank> shape() const {
+        return expr_.shape();
+    }
+
+    template<size_t R>
+    row_type row(const Shape<R>& index, size_t length) const {
+        return row_type(expr_.row(index, length), scalar_);
+    }
+
+    bool flattenable() const {
+        return expr_.flattenable();
+    }
+
+    row_type flatRow() const {
+        return row_type(expr_.flatRow(), scalar_);
+    }
+
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return expr_.aliasing(dst);
+    }
+
+private:
+    detail::operand_t<Expr> expr_;
+    Scalar scalar_;
+};
+
+template<typename LhsExpr, typename RhsExpr>
+TensorBinaryOp<LhsExpr, RhsExpr, detail::SumRows> operator+(const TensorExpression<LhsExpr>& lhs,
+                                                            const TensorExpression<RhsExpr>& rhs) {
+    return TensorBinaryOp<LhsExpr, RhsExpr, detail::SumRows>(lhs, rhs);
+}
+
+template<typename LhsExpr, typename RhsExpr>
+TensorBinaryOp<LhsExpr, RhsExpr, detail::DifferenceRows> operator-(
+    const TensorExpression<LhsExpr>& lhs, const TensorExpression<RhsExpr>& rhs) {
+    return TensorBinaryOp<LhsExpr, RhsExpr, detail::DifferenceRows>(lhs, rhs);
+}
+
+template<typename LhsExpr, typename RhsExpr>
+TensorBinaryOp<LhsExpr, RhsExpr, detail::BinaryRows<detail::MultiplyOp>> operator*(
+    const TensorExpression<LhsExpr>& lhs, const TensorExpression<RhsExpr>& rhs) {
+    return TensorBinaryOp<LhsExpr, RhsExpr, detail::BinaryRows<detail::MultiplyOp>>(lhs, rhs);
+}
+
+template<typename LhsExpr, typename RhsExpr>
+TensorBinaryOp<LhsExpr, RhsExpr, detail::BinaryRows<detail::DivideOp>> operator/(
+    const TensorExpression<LhsExpr>& lhs, const TensorExpression<RhsExpr>& rhs) {
+    return TensorBinaryOp<LhsExpr, RhsExpr, detail::BinaryRows<detail::DivideOp>>(lhs, rhs);
+}
+
+template<typename LhsExpr, typename RhsExpr>
+TensorBinaryOp<LhsExpr, RhsExpr, detail::BinaryRows<detail::MinimumOp>> min(
+    const TensorExpression<LhsExpr>& lhs, const TensorExpression<RhsExpr>& rhs) {
+    return TensorBinaryOp<LhsExpr, RhsExpr, detail::BinaryRows<detail::MinimumOp>>(lhs, rhs);
+}
+
+template<typename LhsExpr, typename RhsExpr>
+TensorBinaryOp<LhsExpr, RhsExpr, detail::BinaryRows<detail::MaximumOp>> max(
+    const TensorExpression<LhsExpr>& lhs, const TensorExpression<RhsExpr>& rhs) {
+    return TensorBinaryOp<LhsExpr, RhsExpr, detail::BinaryRows<detail::MaximumOp>>(lhs, rhs);
+}
+
+template<typename Expr, typename Scalar,
+         typename = std::enable_if_t<std::is_arithmetic_v<Scalar>>>
+TensorScaled<Expr, Scalar> operator*(const TensorExpression<Expr>& expr, Scalar scalar) {
+    return TensorScaled<Expr, Scalar>(expr, scalar);
+}
+
+template<typename Expr, typename Scalar,
+         typename = std::enable_if_t<std::is_arithmetic_v<Scalar>>>
+TensorScaled<Expr, Scalar> operator*(Scalar scalar, const TensorExpression<Expr>& expr) {
+    return TensorScaled<Expr, Scalar>(expr, scalar);
+}
+
+template<typename Expr>
+TensorUnaryOp<Expr, detail::SqrtOp> sqrt(const TensorExpression<Expr>& expr) {
+    return TensorUnaryOp<Expr, detail::SqrtOp>(expr);
+}
+
+template<typename Expr>
+TensorUnaryOp<Expr, detail::AbsOp> abs(const TensorExpression<Expr>& expr) {
+    return TensorUnaryOp<Expr, detail::AbsOp>(expr);
+}
+
+template<typename Expr>
+TensorUnaryOp<Expr, detail::SquareOp> square(const TensorExpression<Expr>& expr) {
+    return TensorUnaryOp<Expr, detail::SquareOp>(expr);
+}
+
+template<typename Expr>
+TensorUnaryOp<Expr, detail::ExpOp> exp(const TensorExpression<Expr>& expr) {
+    return TensorUnaryOp<Expr, detail::ExpOp>(expr);
+}
+
+template<typename Expr>
+TensorUnaryOp<Expr, detail::LogOp> log(const TensorExpression<Expr>& expr) {
+    return TensorUnaryOp<Expr, detail::LogOp>(expr);
+}
+
+template<typename Expr>
+TensorUnaryOp<Expr, detail::TanhOp> tanh(const TensorExpression<Expr>& expr) {
+    return TensorUnaryOp<Expr, detail::TanhOp>(expr);
+}
+
+// ========================
+// 沿某一维归约
+// ========================
+// 结果少一维：形状为 {2, 3, 4} 的表达式沿第1维求和得到形状为 {2, 4} 的张量。
+// 沿最后一维归约时每一行用向量的归约内核求值；沿其他维归约时逐行累加到结果的一行上，
+// 两种情况都沿最内层连续维按SIMD计算。并行版本把结果的行分给线程池；
+// 结果的行数少于线程数时（二维张量沿第0维归约只有一行），把每行切成按缓存行对齐的列块
+namespace detail {
+
+// acc[i] = acc[i] ⊕ row[i]
+template<template<typename> class Op>
+struct AccumulateKernel {
+    template<size_t Bytes, typename T, typename Expr>
+    static ET_ALWAYS_INLINE void run(T* acc, const Expr& row, size_t begin, size_t end) {
+        using O = Op<T>;
+        size_t i = begin;
+        constexpr size_t N = packetLanes<Bytes, Expr>();
+        if constexpr (N != 0 && is_packet_type<T>) {
+            using P = Packet<T, N>;
+            for (; i + N <= end; i += N) {
+                O::combine(P::load(acc + i), packetAs<T, Expr, N>(row, i)).store(acc + i);
+            }
+        }
+        for (; i < end; ++i) {
+            acc[i] = O::combine(acc[i], static_cast<T>(row[i]));
+        }
+    }
+};
+
+template<size_t Rank>
+Shape<Rank - 1> removeAxis(const Shape<Rank>& shape, size_t axis) {
+    Shape<Rank - 1> result{};
+    for (size_t d = 0, k = 0; d < Rank; ++d) {
+        if (d != axis) {
+            result[k++] = shape[d];
+        }
+    }
+    return result;
+}
+
+// 沿 axis（不是最后一维）归约，只计算结果第 r 行的 [begin, end) 列
+template<template<typename> class Op, typename T, typename Expr, size_t Rank>
+void reduceAxisColumns(T* dst, const Expr& expr, const Shape<Rank>& shape, size_t axis, size_t r,
+                       size_t begin, size_t end) {
+    using O = Op<T>;
+    const size_t inner = shape[Rank - 1];
+    const Shape<Rank - 1> outIndex = rowIndex(r, removeAxis(shape, axis));
+    Shape<Rank> index{};
+    for (size_t d = 0; d + 1 < Rank; ++d) {
+        if (d != axis) {
+            index[d] = outIndex[d < axis ? d : d - 1];
+        }
+    }
+    T* acc = dst + r * inner;
+    std::fill(acc + begin, acc + end, O::identity());
+    for (size_t k = 0; k < shape[axis]; ++k) {
+        index[axis] = k;
+        simdDispatch<AccumulateKernel<Op>>(acc, expr.row(index, inner), begin, end);
+    }
+}
+
+// 对结果的 [firstRow, lastRow) 行归约
+template<template<typename> class Op, typename T, typename Expr, size_t Rank>
+void reduceAxisRows(T* dst, const Expr& expr, const Shape<Rank>& shape, size_t axis,
+                    size_t firstRow, size_t lastRow) {
+    const size_t inner = shape[Rank - 1];
+    if (axis == Rank - 1) {
+        // 结果的每个元素是表达式的一行
+        for (size_t r = firstRow; r < lastRow; ++r) {
+            dst[r] = reduce<Op>(expr.row(rowIndex(r, shape), inner));
+        }
+        return;
+    }
+    for (size_t r = firstRow; r < lastRow; ++r) {
+        reduceAxisColumns<Op>(dst, expr, shape, axis, r, 0, inner);
+    }
+}
+
+template<template<typename> class Op, typename Expr>
+Tensor<expression_value_t<Expr>, tensor_rank_v<Expr> - 1> reduceAxis(const Expr& expr, size_t axis,
+                                                                     bool parallelize) {
+    using T = expression_value_t<Expr>;
+    constexpr size_t Rank = tensor_rank_v<Expr>;
+    static_assert(Rank >= 2, "一维张量请直接归约全部元素");
+    if (axis >= Rank) {
+        throw std::invalid_argument("归约的轴越界");
+    }
+    const Shape<Rank> shape = expr.shape();
+    Tensor<T, Rank - 1> result(removeAxis(shape, axis), uninitialized);
+    if (result.size() == 0) {
+        return result;
+    }
+    const size_t rowLength = axis == Rank - 1 ? 1 : shape[Rank - 1];
+    const size_t rows = result.size() / rowLength;
+    ThreadPool& pool = ThreadPool::instance();
+    const size_t threads = pool.workerCount() + 1;
+    if (!parallelize || elementCount(shape) < parallelThreshold() || threads == 1) {
+        reduceAxisRows<Op>(result.data(), expr, shape, axis, 0, rows);
+        return result;
+    }
+    if (rows < threads) {
+        if (axis == Rank - 1) {
+            // 结果只有几个元素：每个元素用向量的并行归约
+            for (size_t r = 0; r < rows; ++r) {
+                result.data()[r] =
+                    reduce<Op>(expr.row(rowIndex(r, shape), shape[Rank - 1]), parallel);
+            }
+            return result;
+        }
+        // 结果的行数少于线程数（例如二维张量沿第0维归约只有一行）：把每行切成列块
+        const size_t block = columnBlockSize<T>(rows, rowLength, threads);
+        const size_t blocksPerRow = (rowLength + block - 1) / block;
+        pool.run(rows * blocksPerRow, [&](size_t c) {
+            const size_t begin = c % blocksPerRow * block;
+            reduceAxisColumns<Op>(result.data(), expr, shape, axis, c / blocksPerRow, begin,
+                                  std::min(rowLength, begin + block));
+        });
+        return result;
+    }
+    // 结果的每一行要读取 shape[axis] 行（沿最后一维归约时是一行中的 shape[axis] 个元素）
+    const size_t work = std::max<size_t>(1, shape[axis] * rowLength);
+    const size_t rowsPerChunk = std::max<size_t>(1, parallelChunkSize<T>() / work);
+    const size_t chunks = (rows + rowsPerChunk - 1) / rowsPerChunk;
+    pool.run(chunks, [&](size_t c) {
+        const size_t first = c * rowsPerChunk;
+        reduceAxisRows<Op>(result.data(), expr, shape, axis, first, std::min(rows, first + rowsPerChunk));
+    });
+    return result;
+}
+
+template<typename Expr>
+void requireNonEmptyAxis(const Expr& expr, size_t axis, const char* what) {
+    if (axis < tensor_rank_v<Expr> && expr.shape()[axis] == 0) {
+        throw std::invalid_argument(what);
+    }
+}
+
+template<typename Expr>
+auto meanAxis(const Expr& expr, size_t axis, bool parallelize) {
+    using T = expression_value_t<Expr>;
+    static_assert(std::is_floating_point_v<T>, "整数张量的均值没有意义，请使用 sum");
+    requireNonEmptyAxis(expr, axis, "空的维没有均值");
+    auto result = reduceAxis<SumOp>(expr, axis, parallelize);
+    const T scale = T(1) / static_cast<T>(expr.shape()[axis]);
+    for (T& x : result) {
+        x *= scale;
+    }
+    return result;
+}
+
+} // namespace detail
+
+template<typename Expr>
+auto sum(const TensorExpression<Expr>& expr, size_t axis) {
+    return detail::reduceAxis<detail::SumOp>(static_cast<const Expr&>(expr), axis, false);
+}
+
+template<typename Expr>
+auto sum(const TensorExpression<Expr>& expr, size_t axis, ParallelTag) {
+    return detail::reduceAxis<detail::SumOp>(static_cast<const Expr&>(expr), axis, true);
+}
+
+template<typename Expr>
+auto mean(const TensorExpression<Expr>& expr, size_t axis) {
+    return detail::meanAxis(static_cast<const Expr&>(expr), axis, false);
+}
+
+template<typename Expr>
+auto mean(const TensorExpression<Expr>& expr, size_t axis, ParallelTag) {
+    return detail::meanAxis(static_cast<const Expr&>(expr), axis, true);
+}
+
+template<typename Expr>
+auto min(const TensorExpression<Expr>& expr, size_t axis) {
+    detail::requireNonEmptyAxis(static_cast<const Expr&>(expr), axis, "空的维没有最小值");
+    return detail::reduceAxis<detail::MinOp>(static_cast<const Expr&>(expr), axis, false);
+}
+
+template<typename Expr>
+auto min(const TensorExpression<Expr>& expr, size_t axis, ParallelTag) {
+    detail::requireNonEmptyAxis(static_cast<const Expr&>(expr), axis, "空的维没有最小值");
+    return detail::reduceAxis<detail::MinOp>(static_cast<const Expr&>(expr), axis, true);
+}
+
+template<typename Expr>
+auto max(const TensorExpression<Expr>& expr, size_t axis) {
+    detail::requireNonEmptyAxis(static_cast<const Expr&>(expr), axis, "空的维没有最大值");
+    return detail::reduceAxis<detail::MaxOp>(static_cast<const Expr&>(expr), axis, false);
+}
+
+template<typename Expr>
+auto max(const TensorExpression<Expr>& expr, size_t axis, ParallelTag) {
+    detail::requireNonEmptyAxis(static_cast<const Expr&>(expr), axis, "空的维没有最大值");
+    return detail::reduceAxis<detail::MaxOp>(static_cast<const Expr&>(expr), axis, true);
+}
+
+// 所有元素之和
+template<typename Expr>
+expression_value_t<Expr> sum(const TensorExpression<Expr>& expr) {
+    const Expr& e = static_cast<const Expr&>(expr);
+    if (e.flattenable()) {
+        return sum(e.flatRow());
+    }
+    constexpr size_t Rank = detail::tensor_rank_v<Expr>;
+    const Shape<Rank> shape = e.shape();
+    const size_t n = detail::elementCount(shape);
+    expression_value_t<Expr> total(0);
+    if (n == 0) {
+        return total;
+    }
+    Shape<Rank> index{};
+    for (size_t r = 0; r < n / shape[Rank - 1]; ++r) {
+        total += sum(e.row(index, shape[Rank - 1]));
+        detail::nextRow(index, shape);
+    }
+    return total;
+}
+
+// ========================
+// 辅助函数
+// ========================
+
+// 打印张量的形状和按行主序排列的前几个元素
+template<typename T, size_t Rank>
+void printTensor(const Tensor<T, Rank>& t, const std::string& name, size_t maxDisplay = 12) {
+    std::cout << name << " (";
+    for (size_t d = 0; d < Rank; ++d) {
+        if (d > 0) std::cout << "x";
+        std::cout << t.extent(d);
+    }
+    std::cout << ") = [";
+    for (size_t i = 0; i < t.size() && i < maxDisplay; ++i) {
+        if (i > 0) std::cout << ", ";
+        std::cout << t.data()[i];
+    }
+    if (t.size() > maxDisplay) {
+        std::cout << ", ...";
+    }
+    std::cout << "]" << std::endl;
+}
+
+} // namespace ExpressionTemplates
+
+#endif // TENSOR_HPP
@@ -0,0 +1,142 @@
+// TiledEvaluation.hpp
+#ifndef TILED_EVALUATION_HPP
+#define TILED_EVALUATION_HPP
+
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+
+#include "SimdPacket.hpp"
+
+namespace ExpressionTemplates {
+
+// ========================
+// 分块求值
+// ========================
+// 普通赋值用一个循环同时流式读取所有叶子。叶子很多（10个以上）时，
+// 并发的数据流超过了硬件预取器能跟踪的数量，L1也放不下每个流正在使用的缓存行。
+// 分块求值把下标空间切成若干块，每块所有数据流合起来不超过 footprintBytes（默认约L1大小），
+// 并可以在每块开始时用软件预取提前 prefetchDistance 个元素取入后面的数据：
+//   result.assign(expr, tiled);
+//   result.assign(expr, Tiling{24 * 1024, 2048});
+// 是否更快取决于叶子数和硬件，用 make run-bench 中的叶子数扫描来确认
+// 数据流很多时按 footprintBytes 平分的块会很短，每次 evaluateRange 的固定开销随之占主导；
+// 因此每个数据流一块至少 minStreamBytes 字节，这时一块的总量超出L1，但仍在L2之内
+struct Tiling {
+    size_t footprintBytes = 24 * 1024;  // 一块内所有数据流（含目标）的总字节数
+    size_t prefetchDistance = 0;         // 软件预取的提前量（元素数），0 表示不预取
+    size_t minStreamBytes = 4 * 1024;    // 每个数据流一块至少的字节数
+};
+
+inline constexpr Tiling tiled{};
+
+namespace detail {
+
+// 节点提供 forEachStream(f) 时，对其中每个叶子的数据流调用 f(首元素地址, 字节步长)
+// 没有提供的节点（例如标量广播）不产生数据流
+template<typename Expr, typename F, typename = void>
+struct has_streams : std::false_type {};
+
+template<typename Expr, typename F>
+struct has_streams<Expr, F, std::void_t<decltype(std::declval<const Expr&>().forEachStream(
+                                std::declval<F&>()))>> : std::true_type {};
+
+template<typename Expr, typename F>
+void forEachStream(const Expr& expr, F& f) {
+    if constexpr (has_streams<Expr, F>::value) {
+        expr.forEachStream(f);
+    }
+}
+
+// 表达式中的全部数据流，超过容量的部分只计数、不预取
+class StreamList {
+public:
+    static constexpr size_t capacity = 32;
+
+    void operator()(const void* first, std::ptrdiff_t strideBytes) {
+        if (count_ < capacity) {
+            streams_[count_] = Stream{static_cast<const char*>(first), strideBytes};
+        }
+        ++count_;
+    }
+
+    size_t count() const {
+        return count_;
+    }
+
+    // 预取下标 [begin, end) 的元素，步长不超过一个缓存行时每行只预取一次
+    template<int Write = 0>
+    void prefetch(size_t begin, size_t end) const {
+        for (size_t s = 0; s < std::min(count_, capacity); ++s) {
+            prefetchStream<Write>(streams_[s], begin, end);
+        }
+    }
+
+    template<int Write = 0>
+    static void prefetchRange(const void* first, std::ptrdiff_t strideBytes, size_t begin,
+                              size_t end) {
+        prefetchStream<Write>(Stream{static_cast<const char*>(first), strideBytes}, begin, end);
+    }
+
+private:
+    struct Stream {
+        const char* first;
+        std::ptrdiff_t stride;
+    };
+
+    template<int Write>
+    static void prefetchStream(const Stream& s, size_t begin, size_t end) {
+        const size_t magnitude = static_cast<size_t>(s.stride < 0 ? -s.stride : s.stride);
+        const size_t step = magnitude == 0 || magnitude >= 64 ? 1 : 64 / magnitude;
+        for (size_t i = begin; i < end; i += step) {
+            prefetchLine<Write>(s.first + static_cast<std::ptrdiff_t>(i) * s.stride);
+        }
+    }
+
+    // 与其他内建函数一样只在GCC/Clang下使用，其他编译器上预取不做任何事
+    template<int Write>
+    static void prefetchLine(const char* address) {
+#if ET_HAS_VECTOR_EXTENSIONS
+        __builtin_prefetch(address, Write, 3);
+#else
+        static_cast<void>(address);
+#endif
+    }
+
+    Stream streams_[capacity];
+    size_t count_ = 0;
+};
+
+// 每块的元素数：按缓存行取整，且不少于每个数据流的最小块长
+template<typename T>
+size_t tileElements(const Tiling& tiling, size_t streams) {
+    constexpr size_t line = 64 / sizeof(T) > 0 ? 64 / sizeof(T) : 1;
+    size_t elements = std::max(tiling.footprintBytes / (streams * sizeof(T)),
+                               tiling.minStreamBytes / sizeof(T));
+    return std::max(elements / line * line, line);
+}
+
+// 计算 dst[i] = expr[i], i ∈ [0, n)，每块仍由 evaluateRange 完成
+template<typename T, typename Expr>
+void evaluateTiled(T* dst, const Expr& expr, size_t n, const Tiling& tiling) {
+    StreamList streams;
+    forEachStream(expr, streams);
+    const size_t tile = tileElements<T>(tiling, streams.count() + 1);
+    const size_t distance = tiling.prefetchDistance;
+    for (size_t begin = 0; begin < n; begin += tile) {
+        const size_t end = std::min(n, begin + tile);
+        if (distance != 0 && begin + distance < n) {
+            const size_t ahead = std::min(n, end + distance);
+            streams.prefetch(begin + distance, ahead);
+            StreamList::prefetchRange<1>(dst, sizeof(T), begin + distance, ahead);
+        }
+        evaluateRange(dst, expr, begin, end);
+    }
+}
+
+} // namespace detail
+
+} // namespace ExpressionTemplates
+
+#endif // TILED_EVALUATION_HPP
@@ -0,0 +1,284 @@
+// VectorView.hpp
+#ifndef VECTOR_VIEW_HPP
+#define VECTOR_VIEW_HPP
+
+#include <stdexcept>
+#include <type_traits>
+
+#include "ExpressionTemplates.hpp"
+#include "SmallVector.hpp"
+
+namespace ExpressionTemplates {
+
+// 运行时才知道步长的视图
+inline constexpr std::ptrdiff_t dynamicStride = 0;
+
+// ========================
+// 向量视图：引用已有存储的一段元素，不复制数据
+// ========================
+// 第i个元素位于 data[i * stride]。步长为1（切片）和-1（反转）时是模板参数，
+// 这两种最常见的访问方式在编译期就确定了packet的加载方式；
+// 其余步长（strided）在运行时保存
+// T 为 const 时视图只读，否则视图也可以作为赋值目标：
+//   slice(v, 2, 8) = a + b;
+template<typename T, std::ptrdiff_t Stride = 1>
+class VectorView;
+
+template<typename T, std::ptrdiff_t Stride>
+struct ExpressionTraits<VectorView<T, Stride>> {
+    using value_type = std::remove_const_t<T>;
+    static constexpr bool vectorizable = detail::is_packet_type<value_type>;
+    static constexpr size_t static_size = 0;
+};
+
+namespace detail {
+
+// 步长不为1的目标：按packet计算表达式，再逐通道写回
+struct StridedAssignKernel {
+    template<size_t Bytes, typename T, typename Expr>
+    static ET_ALWAYS_INLINE void run(T* dst, std::ptrdiff_t stride, const Expr& expr, size_t n) {
+        size_t i = 0;
+        constexpr size_t N = packetLanes<Bytes, Expr>();
+        if constexpr (N != 0 && is_packet_type<T>) {
+            for (; i + N <= n; i += N) {
+                auto p = expr.template packet<N>(i).template cast<T>();
+                for (size_t k = 0; k < N; ++k) {
+                    dst[static_cast<std::ptrdiff_t>(i + k) * stride] = p[k];
+                }
+            }
+        }
+        for (; i < n; ++i) {
+            dst[static_cast<std::ptrdiff_t>(i) * stride] = expr[i];
+        }
+    }
+};
+
+} // namespace detail
+
+template<typename T, std::ptrdiff_t Stride>
+class VectorView : public VectorExpression<VectorView<T, Stride>> {
+public:
+    using value_type = std::remove_const_t<T>;
+
+    VectorView(T* data, size_t size, std::ptrdiff_t stride = Stride)
+        : data_(data), size_(size), stride_(stride) {
+        if (stride == 0 || (Stride != dynamicStride && stride != Stride)) {
+            throw std::invalid_argument("视图步长无效");
+        }
+    }
+
+    // 复制构造得到指向同一段存储的视图（浅复制）
+    VectorView(const VectorView&) = default;
+
+    // 赋值则与 std::valarray 的 slice_array 一样复制元素，而不是让视图改指别处
+    VectorView& operator=(const VectorView& other) {
+        return *this = static_cast<const VectorExpression<VectorView>&>(other);
+    }
+
+    // 把表达式写入视图引用的元素
+    // 与Vector一样先做别名分析：表达式与视图错位重叠时（slice(v, 1, n) = slice(v, 0, n - 1)）
+    // 先求值到临时向量再写回
+    template<typename Expr>
+    VectorView& operator=(const VectorExpression<Expr>& expr) {
+        static_assert(!std::is_const_v<T>, "只读视图不能作为赋值目标");
+        if (expr.size() != size_) {
+            throw std::invalid_argument("向量大小不匹配");
+        }
+        if (expr.aliasing(region()) == detail::AliasKind::Overlap) {
+            Vector<value_type> temp(expr);
+            return assignDirect(temp);
+        }
+        return assignDirect(expr);
+    }
+
+    // 调用者保证表达式不与视图错位重叠，跳过别名检查
+    detail::NoAlias<VectorView> noalias() {
+        return detail::NoAlias<VectorView>(*this);
+    }
+
+    T& operator[](size_t i) const {
+        return data_[offset(i)];
+    }
+
+    // 步长为1时直接加载，为-1时加载后反转通道顺序，其余步长逐通道收集
+    template<size_t N>
+    ET_ALWAYS_INLINE Packet<value_type, N> packet(size_t i) const {
+        if constexpr (Stride == 1) {
+            return Packet<value_type, N>::load(data_ + i);
+        } else if constexpr (Stride == -1) {
+            auto p = Packet<value_type, N>::load(data_ - i - (N - 1));
+            Packet<value_type, N> r;
+            for (size_t k = 0; k < N; ++k) {
+                r.set(k, p[N - 1 - k]);
+            }
+            return r;
+        } else {
+            Packet<value_type, N> r;
+            for (size_t k = 0; k < N; ++k) {
+                r.set(k, data_[offset(i + k)]);
+            }
+            return r;
+        }
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    std::ptrdiff_t stride() const {
+        return stride_;
+    }
+
+    // 第0个元素的地址
+    T* data() const {
+        return data_;
+    }
+
+    detail::MemoryRegion region() const {
+        return detail::MemoryRegion{data_, size_, sizeof(T),
+                                    stride_ * static_cast<std::ptrdiff_t>(sizeof(T))};
+    }
+
+    detail::AliasKind aliasing(const detail::MemoryRegion& dst) const {
+        return detail::leafAliasing(data_, size_, stride_, dst);
+    }
+
+    template<typename F>
+    void forEachStream(F& f) const {
+        f(data_, stride_ * static_cast<std::ptrdiff_t>(sizeof(T)));
+    }
+
+    // [begin, end) 范围内的子视图，步长不变
+    VectorView slice(size_t begin, size_t end) const {
+        if (begin > end || end > size_) {
+            throw std::invalid_argument("切片范围越界");
+        }
+        return VectorView(data_ + offset(begin), end - begin, stride_);
+    }
+
+    // 每隔step个元素取一个
+    VectorView<T, dynamicStride> strided(size_t step) const {
+        if (step == 0) {
+            throw std::invalid_argument("视图步长无效");
+        }
+        return VectorView<T, dynamicStride>(data_, (size_ + step - 1) / step,
+                                            stride_ * static_cast<std::ptrdiff_t>(step));
+    }
+
+    // 逆序视图，第0个元素是原来的最后一个
+    auto reversed() const {
+        constexpr std::ptrdiff_t reversedStride = Stride == dynamicStride ? dynamicStride : -Stride;
+        T* first = size_ == 0 ? data_ : data_ + offset(size_ - 1);
+        return VectorView<T, reversedStride>(first, size_, -stride_);
+    }
+
+private:
+    friend class detail::NoAlias<VectorView>;
+
+    std::ptrdiff_t offset(size_t i) const {
+        if constexpr (Stride == dynamicStride) {
+            return static_cast<std::ptrdiff_t>(i) * stride_;
+        } else {
+            return static_cast<std::ptrdiff_t>(i) * Stride;
+        }
+    }
+
+    template<typename Expr>
+    VectorView& assignDirect(const VectorExpression<Expr>& expr) {
+        if (expr.size() != size_) {
+            throw std::invalid_argument("向量大小不匹配");
+        }
+        if constexpr (Stride == 1) {
+            detail::evaluateRange(data_, static_cast<const Expr&>(expr), 0, size_);
+        } else {
+            detail::simdDispatch<detail::StridedAssignKernel>(data_, stride_,
+                                                              static_cast<const Expr&>(expr),
+                                                              size_);
+        }
+        return *this;
+    }
+
+    T* data_;
+    size_t size_;
+    std::ptrdiff_t stride_;
+};
+
+// ========================
+// 创建视图
+// ========================
+namespace detail {
+
+// 整个容器的视图；const 容器得到只读视图
+template<typename T>
+VectorView<T> fullView(Vector<T>& v) {
+    return VectorView<T>(v.data(), v.size());
+}
+
+template<typename T>
+VectorView<const T> fullView(const Vector<T>& v) {
+    return VectorView<const T>(v.data(), v.size());
+}
+
+template<typename T, size_t N>
+VectorView<T> fullView(StaticVector<T, N>& v) {
+    return VectorView<T>(v.data(), N);
+}
+
+template<typename T, size_t N>
+VectorView<const T> fullView(const StaticVector<T, N>& v) {
+    return VectorView<const T>(v.data(), N);
+}
+
+template<typename T, size_t InlineCapacity>
+VectorView<T> fullView(SmallVector<T, InlineCapacity>& v) {
+    return VectorView<T>(v.data(), v.size());
+}
+
+template<typename T, size_t InlineCapacity>
+VectorView<const T> fullView(const SmallVector<T, InlineCapacity>& v) {
+    return VectorView<const T>(v.data(), v.size());
+}
+
+template<typename T, std::ptrdiff_t Stride>
+VectorView<T, Stride> fullView(const VectorView<T, Stride>& v) {
+    return v;
+}
+
+template<typename Container>
+struct IsView : std::false_type {};
+
+template<typename T, std::ptrdiff_t Stride>
+struct IsView<VectorView<T, Stride>> : std::true_type {};
+
+// 临时向量在语句结束时就会销毁，不能为它创建视图
+template<typename Container>
+auto viewOf(Container&& c) {
+    static_assert(std::is_lvalue_reference_v<Container> ||
+                  IsView<std::decay_t<Container>>::value,
+                  "不能为临时向量创建视图");
+    return fullView(c);
+}
+
+} // namespace detail
+
+// v[begin, end)
+template<typename Container>
+auto slice(Container&& v, size_t begin, size_t end) {
+    return detail::viewOf(std::forward<Container>(v)).slice(begin, end);
+}
+
+// v[0], v[step], v[2 * step], ...，例如交错存储的多通道数据中的一个通道
+template<typename Container>
+auto strided(Container&& v, size_t step) {
+    return detail::viewOf(std::forward<Container>(v)).strided(step);
+}
+
+// 逆序
+template<typename Container>
+auto reverse(Container&& v) {
+    return detail::viewOf(std::forward<Container>(v)).reversed();
+}
+
+} // namespace ExpressionTemplates
+
+#endif // VECTOR_VIEW_HPP
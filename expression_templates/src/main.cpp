@@ -1,13 +1,31 @@
 // main.cpp
 #include "ExpressionTemplates.hpp"
+#include "ElementwiseOps.hpp"
+#include "VectorView.hpp"
+#include "FusedEvaluation.hpp"
+#include "SparseVector.hpp"
+#include "MappedVector.hpp"
+#include "Reductions.hpp"
+#include "Scans.hpp"
+#include "Stencil.hpp"
+#include "RuntimeExpression.hpp"
+#include "SharedExpression.hpp"
+#include "SmallVector.hpp"
+#include "Tensor.hpp"
+#include "Batch.hpp"
+#include "Matrix.hpp"
 #include <iostream>
 #include <iomanip>
+#include <cstdio>
+#include <filesystem>
 
 using namespace ExpressionTemplates;
 
 int main() {
     try {
         std::cout << "===== 表达式模板示例开始 =====" << std::endl;
+        std::cout << "SIMD指令集: " << simdLevelName(simdLevel()) << std::endl;
+        std::cout << "并行线程数: " << ThreadPool::instance().workerCount() + 1 << std::endl;
         
         // 创建一些测试向量
         Vector<double> a(5, 1.0);  // 5个元素，初始值全为1.0
@@ -28,8 +46,8 @@ int main() {
         // 基本向量操作
         std::cout << "\n-- 基本向量操作 --" << std::endl;
         
-        Vector<double> sum = a + b;
-        printVector(sum, "a + b");
+        Vector<double> sumVec = a + b;
+        printVector(sumVec, "a + b");
         
         Vector<double> diff = a - b;
         printVector(diff, "a - b");
@@ -65,9 +83,14 @@ int main() {
         Vector<double> complexMath = sqrt(square(a) + square(b));
         printVector(complexMath, "sqrt(square(a) + square(b))");
         
+        // 超越函数同样按packet求值，不再退化为逐元素调用 std::exp
+        Vector<double> transcendental = exp(a * -1.0) * sin(b) + log(c) - tanh(a - b);
+        printVector(transcendental, "exp(a * -1.0) * sin(b) + log(c) - tanh(a - b)");
+        
         // 表达式模板实际上只会在赋值时求值，即惰性求值
         std::cout << "\n-- 惰性求值示例 --" << std::endl;
         
+        // 叶子向量按引用保存，中间节点按值保存，表达式可以安全地保存下来稍后求值
         auto expression = a + b * 2.0 - c;
         std::cout << "表达式已创建，但尚未求值" << std::endl;
         
@@ -76,6 +99,201 @@ int main() {
         std::cout << "表达式已求值并存储到结果向量中" << std::endl;
         printVector(result, "result");
         
+        // 值类型沿表达式树推导，float流水线全程保持float
+        std::cout << "\n-- 值类型推导 --" << std::endl;
+        Vector<float> fa(5, 1.5f);
+        Vector<float> fb(5, 0.25f);
+        auto floatExpr = fa + fb;
+        Vector<float> floatResult = floatExpr * 2.0;
+        printVector(floatResult, "(fa + fb) * 2.0 [float]");
+        std::cout << "float + float 的值类型大小: "
+                  << sizeof(decltype(floatExpr)::value_type) << " 字节" << std::endl;
+        Vector<int> ia(5, 3);
+        Vector<int> intResult = ia + ia;
+        printVector(intResult, "ia + ia [int]");
+        std::cout << "int + double 的值类型大小: "
+                  << sizeof(decltype(ia + a)::value_type) << " 字节" << std::endl;
+        
+        // 逐元素乘除、min/max、比较与按掩码选择，都融合在同一个循环里
+        std::cout << "\n-- 逐元素运算与掩码 --" << std::endl;
+        Vector<double> product = a * b;
+        printVector(product, "a * b");
+        Vector<double> quotient = c / b;
+        printVector(quotient, "c / b");
+        Vector<double> clipped = min(max(a * 2.0, b), c);
+        printVector(clipped, "min(max(a * 2.0, b), c)");
+        Vector<double> selected = where(a * 2.0 > b, a, b - c);
+        printVector(selected, "where(a * 2.0 > b, a, b - c)");
+        std::cout << "count(b > 2.0) = " << count(b > 2.0) << " (满足条件的元素个数)" << std::endl;
+        
+        // 视图引用已有存储，既能参与表达式也能作为赋值目标，全程不复制数据
+        std::cout << "\n-- 向量视图 --" << std::endl;
+        printVector(slice(a, 1, 4), "slice(a, 1, 4)");
+        printVector(strided(c, 2), "strided(c, 2)");
+        printVector(reverse(b), "reverse(b)");
+        Vector<double> window(5, 0.0);
+        slice(window, 0, 4) = slice(a, 1, 5) - slice(a, 0, 4);
+        printVector(window, "slice(window, 0, 4) = a[i + 1] - a[i]");
+        // 目标与操作数错位重叠，别名分析自动改走临时缓冲区
+        reverse(window) = window;
+        printVector(window, "reverse(window) = window");
+        
+        // 多个结果在同一个循环里求出，a和b只读一遍
+        std::cout << "\n-- 多输出融合求值 --" << std::endl;
+        Vector<double> half1, half2;
+        evaluate(tie(half1, half2), tie(a + b, a - b));
+        printVector(half1, "a + b");
+        printVector(half2, "a - b");
+        
+        // 归约直接消费表达式，一次遍历且不分配内存
+        std::cout << "\n-- 融合归约 --" << std::endl;
+        std::cout << "sum(a + b) = " << sum(a + b) << std::endl;
+        std::cout << "dot(a - b, a - b) = " << dot(a - b, a - b) << std::endl;
+        std::cout << "norm2(c) = " << norm2(c) << std::endl;
+        std::cout << "min(a - c) = " << min(a - c) << ", max(a - c) = " << max(a - c) << std::endl;
+        std::cout << "any(a - b) = " << std::boolalpha << any(a - b)
+                  << ", all(a - a) = " << all(a - a) << std::noboolalpha << std::endl;
+        
+        // 求和方式：大小悬殊的元素相加时普通求和会丢掉小的元素
+        Vector<double> wide(4);
+        wide[0] = 1.0;
+        wide[1] = 1e100;
+        wide[2] = 1.0;
+        wide[3] = -1e100;
+        std::cout << "sum({1, 1e100, 1, -1e100}): 普通 = " << sum(wide)
+                  << ", Kahan = " << sum(wide, Summation::Kahan)
+                  << ", Neumaier = " << sum(wide, Summation::Neumaier)
+                  << ", 两两求和 = " << sum(wide, Summation::Pairwise) << std::endl;
+        
+        // 前缀扫描：输入表达式在扫描过程中求值
+        std::cout << "\n-- 前缀扫描 --" << std::endl;
+        printVector(inclusive_scan(a + b), "inclusive_scan(a + b)");
+        printVector(exclusive_scan(a + b), "exclusive_scan(a + b)");
+        printVector(running_max(c - a), "running_max(c - a)");
+        
+        // 模板与滑动窗口：边界按策略取值，直接赋值时按块求值
+        std::cout << "\n-- 模板与滑动窗口 --" << std::endl;
+        Vector<double> laplace = stencil(a + b, std::array<double, 3>{1.0, -2.0, 1.0}, boundary::clamp, 1);
+        printVector(laplace, "stencil(a + b, {1, -2, 1}, clamp)");
+        printVector(stencil(a, {0.5, 0.5}, boundary::wrap), "stencil(a, {0.5, 0.5}, wrap)");
+        printVector(moving_sum(c, 3, boundary::zero, 1), "moving_sum(c, 3, zero)");
+        printVector(moving_mean(c, 3, boundary::clamp, 1), "moving_mean(c, 3, clamp)");
+        
+        // 运行时表达式图：公式在运行时组合，编译为字节码后按块解释执行
+        std::cout << "\n-- 运行时表达式 --" << std::endl;
+        ExpressionGraph<double> graph;
+        auto ga = graph.input(a);
+        auto gb = graph.input(b);
+        auto gc = graph.input(c);
+        CompiledExpression<double> program = graph.compile(ga + gb * 2.0 - gc);
+        Vector<double> interpreted = program;
+        printVector(interpreted, "运行时 a + b * 2.0 - c");
+        std::cout << "字节码: " << program.instructions().size() << " 条指令, "
+                  << program.registerCount() << " 个寄存器" << std::endl;
+        printVector(graph.compile(graph.apply(Opcode::Maximum, {ga, gc}) - sqrt(gb)),
+                    "运行时 max(a, c) - sqrt(b)");
+        
+        // 公共子表达式：share() 的副本共用一份按块求值的缓存
+        std::cout << "\n-- 公共子表达式 --" << std::endl;
+        auto shared = share(a + b);
+        Vector<double> squared = shared * shared - shared;
+        printVector(squared, "s * s - s, s = share(a + b)");
+        
+        // 定长向量：长度在类型里，编译期检查大小，赋值完全展开
+        std::cout << "\n-- 定长向量 --" << std::endl;
+        StaticVector<double, 3> p{1.0, 2.0, 3.0};
+        StaticVector<double, 3> q{0.5, 0.5, 0.5};
+        StaticVector<double, 3> r = p + q * 2.0 - p;
+        printVector(r, "q * 2.0");
+        std::cout << "dot(p, q) = " << dot(p, q) << ", norm2(p) = " << norm2(p) << std::endl;
+        // p + a;  // 编译错误：StaticVector不能与动态Vector混合运算
+        std::cout << "sizeof(StaticVector<double, 3>) = " << sizeof(p) << " 字节" << std::endl;
+        
+        // 小向量：长度在运行时决定，不超过对象内存储时不分配堆内存
+        std::cout << "\n-- 小向量 --" << std::endl;
+        SmallVector<double, 8> small = a + b * 2.0;
+        printVector(small - c, "SmallVector: a + b * 2.0 - c");
+        std::cout << "对象内存储: " << std::boolalpha << small.isInline() << std::noboolalpha
+                  << ", sizeof(SmallVector<double, 8>) = " << sizeof(small) << " 字节" << std::endl;
+        
+        // 张量：按NumPy规则广播，沿最内层维SIMD求值，可沿任意一维归约
+        std::cout << "\n-- 张量 --" << std::endl;
+        Tensor<double, 2> grid({2, 3}, {1.0, 2.0, 3.0, 4.0, 5.0, 6.0});
+        Tensor<double, 1> offsets({3}, {0.5, 1.5, 2.5});
+        Tensor<double, 2> rowScale({2, 1}, {1.0, 10.0});
+        Tensor<double, 2> broadcasted = grid * rowScale + offsets;
+        printTensor(broadcasted, "grid * rowScale + offsets");
+        printTensor(sum(broadcasted, 0), "sum(..., 0)");
+        printTensor(max(broadcasted, 1), "max(..., 1)");
+        
+        // 批量小向量：分量分开存储，表达式在实体方向上向量化
+        std::cout << "\n-- 批量小向量 --" << std::endl;
+        Batch<double, 3> position(5), velocity(5);
+        Batch<double, 1> mass(5, 2.0);
+        for (size_t e = 0; e < position.count(); ++e) {
+            position.set(e, {1.0 * e, 0.0, -1.0});
+            velocity.set(e, {1.0, 0.5 * e, 2.0});
+        }
+        position = position + velocity * 0.1;
+        printBatch(position, "position + velocity * 0.1");
+        printBatch(Batch<double, 3>(velocity * mass), "velocity * mass");
+        printBatch(Batch<double, 1>(norm2(velocity)), "norm2(velocity)");
+        
+        // 稀疏向量：只保存非零元素，运算代价与非零元素个数成正比
+        std::cout << "\n-- 稀疏向量 --" << std::endl;
+        SparseVector<double> s1(5, {0, 3}, {1.0, 4.0});
+        SparseVector<double> s2(5, {1, 3}, {2.0, 0.5});
+        SparseVector<double> s3 = s1 * 2.0 - s2;
+        std::cout << "s1 * 2.0 - s2 有 " << s3.nonZeros() << " 个非零元素" << std::endl;
+        printVector(toDense(s3), "s1 * 2.0 - s2");
+        // 稀疏与稠密混合：先写入稠密部分，再只修正非零位置
+        Vector<double> mixed = c - s1;
+        printVector(mixed, "c - s1");
+        std::cout << "dot(s1, a) = " << dot(s1, a) << ", sum(s1 * a) = " << sum(s1 * a)
+                  << std::endl;
+        
+        // 内存映射向量：保存后直接映射文件，元素按需从页缓存载入，不必整体读入
+        std::cout << "\n-- 内存映射向量 --" << std::endl;
+        std::string mappedPath = (std::filesystem::temp_directory_path() / "et_demo_c.bin").string();
+        c.save(mappedPath);
+        {
+            MappedVector<double> mc(mappedPath);
+            Vector<double> fromFile = mc * 2.0 - a;
+            printVector(fromFile, "mapped(c) * 2.0 - a");
+            // 写时复制：修改只在本进程可见，文件保持不变
+            MappedVector<double> cow(mappedPath, MapMode::CopyOnWrite);
+            cow = cow + b;
+            printVector(cow, "cow = cow + b");
+        }
+        std::remove(mappedPath.c_str());
+        
+        // 矩阵表达式复用同一套CRTP机制
+        std::cout << "\n-- 矩阵表达式 --" << std::endl;
+        Matrix<double> m1(2, 3);
+        Matrix<double> m2(3, 2, 1.0);
+        for (size_t r = 0; r < 2; ++r) {
+            for (size_t col = 0; col < 3; ++col) {
+                m1(r, col) = static_cast<double>(r * 3 + col + 1);
+            }
+        }
+        printMatrix(m1, "m1");
+        Matrix<double> mt = transpose(m1) + m2 * 2.0;
+        printMatrix(mt, "transpose(m1) + m2 * 2.0");
+        // 目标出现在转置视图里：别名分析改走临时缓冲区，结果仍然正确
+        Matrix<double> sq(2, 2);
+        sq(0, 0) = 1.0; sq(0, 1) = 2.0; sq(1, 0) = 3.0; sq(1, 1) = 4.0;
+        sq = transpose(sq) + sq;
+        printMatrix(sq, "sq = transpose(sq) + sq");
+        // 确定不重叠时用noalias()跳过检查
+        mt.noalias() = transpose(m1) * 3.0;
+        printMatrix(mt, "mt.noalias() = transpose(m1) * 3.0");
+        Matrix<double> mp = m1 * m2;
+        printMatrix(mp, "m1 * m2");
+        Vector<double> x(3, 1.0);
+        x[2] = 2.0;
+        Vector<double> mv = m1 * x;
+        printVector(mv, "m1 * x");
+        
         // 性能对比
         std::cout << "\n-- 性能对比 (小向量) --" << std::endl;
         comparePerformance<1000>();
@@ -86,6 +304,11 @@ int main() {
         std::cout << "\n-- 性能对比 (大向量) --" << std::endl;
         comparePerformance<1000000>();
         
+        std::cout << "\n-- 矩阵乘法性能对比 --" << std::endl;
+        compareGemmPerformance<64>();
+        compareGemmPerformance<256>();
+        compareGemmPerformance<512>();
+        
         std::cout << "\n===== 表达式模板示例结束 =====" << std::endl;
     } catch (const std::exception& e) {
         std::cerr << "异常: " << e.what() << std::endl;